@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/CombatCoordinatorSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat Coordinator"), STAT_CombatCoordinator, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attack Tokens Held"), STAT_AttackTokensHeld, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Circling"), STAT_EnemiesCircling, STATGROUP_Slash);
+// attack requests dropped without a token, a proxy for the weapon traces those swings would have made
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Swings Avoided"), STAT_WeaponSwingsAvoided, STATGROUP_Slash);
+
+static TAutoConsoleVariable<int32> CVarCombatMaxAttackers(
+	TEXT("slash.Combat.MaxAttackers"),
+	2,
+	TEXT("How many enemies may attack the same target at once, 0 for no limit."));
+
+static TAutoConsoleVariable<float> CVarCombatWaitWeight(
+	TEXT("slash.Combat.WaitWeight"),
+	200.f,
+	TEXT("Distance in cm a waiting enemy is moved up the queue for every second it has waited."));
+
+static TAutoConsoleVariable<float> CVarCombatMaxTokenHoldTime(
+	TEXT("slash.Combat.MaxTokenHoldTime"),
+	5.f,
+	TEXT("Seconds after which an attack token is taken back even if the attack never ended."));
+
+// waiters that stop asking, e.g. because they left attack range, are dropped after this long
+static constexpr double WaiterTimeout = 1.0;
+
+void UCombatCoordinatorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_CombatCoordinator);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double MaxHoldTime = CVarCombatMaxTokenHoldTime.GetValueOnGameThread();
+	int32 NumHolders = 0;
+	int32 NumWaiters = 0;
+
+	for (auto It = TokenSlots.CreateIterator(); It; ++It)
+	{
+		const AActor* Target = It.Key().ResolveObjectPtr();
+		FAttackTokenSlots& Slots = It.Value();
+
+		for (int32 Index = Slots.Holders.Num() - 1; Index >= 0; --Index)
+		{
+			const FAttackTokenHolder& Holder = Slots.Holders[Index];
+			if (Target == nullptr || Holder.Enemy.ResolveObjectPtr() == nullptr || Now - Holder.GrantTime > MaxHoldTime)
+			{
+				HolderTargets.Remove(Holder.Enemy);
+				Slots.Holders.RemoveAtSwap(Index);
+			}
+		}
+		for (int32 Index = Slots.Waiters.Num() - 1; Index >= 0; --Index)
+		{
+			const FAttackTokenWaiter& Waiter = Slots.Waiters[Index];
+			if (Target == nullptr || Waiter.Enemy.ResolveObjectPtr() == nullptr || Now - Waiter.LastRequestTime > WaiterTimeout)
+			{
+				RemoveWaiter(Slots, Index, false);
+			}
+		}
+
+		if (Target == nullptr || (Slots.Holders.Num() == 0 && Slots.Waiters.Num() == 0))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		GrantTokens(Target, Slots, Now);
+		NumHolders += Slots.Holders.Num();
+		NumWaiters += Slots.Waiters.Num();
+	}
+
+	SET_DWORD_STAT(STAT_AttackTokensHeld, NumHolders);
+	SET_DWORD_STAT(STAT_EnemiesCircling, NumWaiters);
+}
+
+TStatId UCombatCoordinatorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatCoordinatorSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatCoordinatorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCombatCoordinatorSubsystem::RequestAttackToken(AEnemy* Enemy, AActor* Target)
+{
+	if (Enemy == nullptr || Target == nullptr) return false;
+	if (CVarCombatMaxAttackers.GetValueOnGameThread() <= 0) return true;
+
+	// a token or a place in the queue is only good for one target, switching targets gives it back
+	const TObjectKey<AActor> TargetKey(Target);
+	const TObjectKey<AActor>* HeldTarget = HolderTargets.Find(Enemy);
+	if (HeldTarget && *HeldTarget == TargetKey) return true;
+	const TObjectKey<AActor>* WaitedTarget = WaiterTargets.Find(Enemy);
+	if (HeldTarget || (WaitedTarget && *WaitedTarget != TargetKey))
+	{
+		ReleaseAttackToken(Enemy);
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	FAttackTokenSlots& Slots = TokenSlots.FindOrAdd(Target);
+
+	const TObjectKey<AEnemy> EnemyKey(Enemy);
+	FAttackTokenWaiter* Waiter = Slots.Waiters.FindByPredicate([&EnemyKey](const FAttackTokenWaiter& Entry) { return Entry.Enemy == EnemyKey; });
+	if (Waiter == nullptr)
+	{
+		Waiter = &Slots.Waiters.AddDefaulted_GetRef();
+		Waiter->Enemy = EnemyKey;
+		Waiter->WaitStartTime = Now;
+		WaiterTargets.Add(EnemyKey, TargetKey);
+	}
+	Waiter->LastRequestTime = Now;
+
+	// the requester hasn't switched to circling yet, so it is eligible whatever its state
+	GrantTokens(Target, Slots, Now, Enemy);
+	return HolderTargets.Contains(Enemy);
+}
+
+void UCombatCoordinatorSubsystem::ReleaseAttackToken(AEnemy* Enemy)
+{
+	const TObjectKey<AEnemy> EnemyKey(Enemy);
+
+	TObjectKey<AActor> Target;
+	if (HolderTargets.RemoveAndCopyValue(EnemyKey, Target))
+	{
+		if (FAttackTokenSlots* Slots = TokenSlots.Find(Target))
+		{
+			Slots->Holders.RemoveAllSwap([&EnemyKey](const FAttackTokenHolder& Holder) { return Holder.Enemy == EnemyKey; });
+		}
+	}
+
+	// chasing, patrolling or dead enemies must not be handed a token they'd sit on
+	if (const TObjectKey<AActor>* WaitedTarget = WaiterTargets.Find(EnemyKey))
+	{
+		if (FAttackTokenSlots* Slots = TokenSlots.Find(*WaitedTarget))
+		{
+			const int32 Index = Slots->Waiters.IndexOfByPredicate([&EnemyKey](const FAttackTokenWaiter& Entry) { return Entry.Enemy == EnemyKey; });
+			if (Index != INDEX_NONE)
+			{
+				RemoveWaiter(*Slots, Index, false);
+				return;
+			}
+		}
+		WaiterTargets.Remove(EnemyKey);
+	}
+}
+
+void UCombatCoordinatorSubsystem::RemoveWaiter(FAttackTokenSlots& Slots, int32 Index, bool bGranted)
+{
+	WaiterTargets.Remove(Slots.Waiters[Index].Enemy);
+	Slots.Waiters.RemoveAtSwap(Index);
+	if (!bGranted)
+	{
+		++NumSwingsAvoided;
+		INC_DWORD_STAT(STAT_WeaponSwingsAvoided);
+	}
+}
+
+bool UCombatCoordinatorSubsystem::IsWaitingToAttack(const AEnemy* Enemy)
+{
+	const EEnemyState State = Enemy->GetEnemyState();
+	return State == EEnemyState::EES_Circling || State == EEnemyState::EES_Attacking;
+}
+
+int32 UCombatCoordinatorSubsystem::GetNumTokenHolders(AActor* Target) const
+{
+	const FAttackTokenSlots* Slots = TokenSlots.Find(Target);
+	return Slots ? Slots->Holders.Num() : 0;
+}
+
+void UCombatCoordinatorSubsystem::GrantTokens(const AActor* Target, FAttackTokenSlots& Slots, double Now, const AEnemy* Requester)
+{
+	const int32 MaxAttackers = CVarCombatMaxAttackers.GetValueOnGameThread();
+	const FVector TargetLocation = Target->GetActorLocation();
+
+	// waiters that stopped circling, e.g. chasing or dead, have given up on this attack
+	for (int32 Index = Slots.Waiters.Num() - 1; Index >= 0; --Index)
+	{
+		const AEnemy* Enemy = Slots.Waiters[Index].Enemy.ResolveObjectPtr();
+		if (Enemy == nullptr || (Enemy != Requester && !IsWaitingToAttack(Enemy)))
+		{
+			RemoveWaiter(Slots, Index, false);
+		}
+	}
+
+	while (Slots.Holders.Num() < MaxAttackers && Slots.Waiters.Num() > 0)
+	{
+		int32 BestIndex = INDEX_NONE;
+		double BestScore = TNumericLimits<double>::Max();
+		for (int32 Index = 0; Index < Slots.Waiters.Num(); ++Index)
+		{
+			const double Score = ScoreWaiter(Slots.Waiters[Index], TargetLocation, Now);
+			if (Score < BestScore)
+			{
+				BestScore = Score;
+				BestIndex = Index;
+			}
+		}
+		if (BestIndex == INDEX_NONE) break;
+
+		AEnemy* Enemy = Slots.Waiters[BestIndex].Enemy.ResolveObjectPtr();
+		RemoveWaiter(Slots, BestIndex, Enemy != nullptr);
+		if (Enemy == nullptr) continue;
+
+		Slots.Holders.Add({ TObjectKey<AEnemy>(Enemy), Now });
+		HolderTargets.Add(Enemy, Target);
+	}
+}
+
+double UCombatCoordinatorSubsystem::ScoreWaiter(const FAttackTokenWaiter& Waiter, const FVector& TargetLocation, double Now) const
+{
+	const AEnemy* Enemy = Waiter.Enemy.ResolveObjectPtr();
+	if (Enemy == nullptr) return TNumericLimits<double>::Max();
+
+	// nearest first, but every second spent waiting counts as being a bit closer so nobody starves
+	const double Distance = FVector::Dist(Enemy->GetActorLocation(), TargetLocation);
+	return Distance - (Now - Waiter.WaitStartTime) * CVarCombatWaitWeight.GetValueOnGameThread();
+}
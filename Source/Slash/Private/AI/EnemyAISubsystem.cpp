@@ -0,0 +1,556 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/EnemyAISubsystem.h"
+#include "Enemy/Enemy.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "IAnimationBudgetAllocator.h"
+#include "AnimationBudgetAllocatorParameters.h"
+#include "Async/ParallelFor.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/Engine.h"
+#include "NavigationSystem.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy AI Schedule"), STAT_EnemyAISchedule, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Enemy AI Gather"), STAT_EnemyAIGather, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Enemy AI Evaluate"), STAT_EnemyAIEvaluate, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Enemy AI Apply"), STAT_EnemyAIApply, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Enemies"), STAT_EnemyAIRegistered, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Updated"), STAT_EnemyAIUpdated, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Enemy Chase Steering"), STAT_EnemyChaseSteering, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Chasing By Flow Field"), STAT_EnemyFlowFieldChasers, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Enemy Anim Snapshots"), STAT_EnemyAnimSnapshots, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Anim Snapshots Pushed"), STAT_EnemyAnimSnapshotsPushed, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Flow Field Rebuilds"), STAT_FlowFieldRebuilds, STATGROUP_Slash);
+
+static TAutoConsoleVariable<float> CVarEnemyAINearDistance(
+	TEXT("slash.AI.NearDistance"),
+	1500.f,
+	TEXT("Enemies closer than this to the player update every frame."));
+
+static TAutoConsoleVariable<float> CVarEnemyAIFarDistance(
+	TEXT("slash.AI.FarDistance"),
+	4000.f,
+	TEXT("Enemies further than this from the player use the far update interval."));
+
+static TAutoConsoleVariable<int32> CVarEnemyAIMidInterval(
+	TEXT("slash.AI.MidInterval"),
+	4,
+	TEXT("Update every Nth frame for enemies between the near and far distance."));
+
+static TAutoConsoleVariable<int32> CVarEnemyAIFarInterval(
+	TEXT("slash.AI.FarInterval"),
+	16,
+	TEXT("Update every Nth frame for enemies beyond the far distance or not rendered."));
+
+static TAutoConsoleVariable<float> CVarEnemyAIBudgetMs(
+	TEXT("slash.AI.BudgetMs"),
+	0.5f,
+	TEXT("Game thread budget in milliseconds for non critical enemy updates per frame, 0 for unlimited."));
+
+static TAutoConsoleVariable<bool> CVarEnemyAIShowStats(
+	TEXT("slash.AI.ShowStats"),
+	false,
+	TEXT("Print how many enemies were updated each frame to the screen."));
+
+static TAutoConsoleVariable<bool> CVarEnemyAIFlowFieldChase(
+	TEXT("slash.AI.FlowFieldChase"),
+	true,
+	TEXT("Chasing enemies follow a shared flow field towards their target instead of each running MoveTo."));
+
+static TAutoConsoleVariable<float> CVarEnemyAIFlowFieldCellSize(
+	TEXT("slash.AI.FlowFieldCellSize"),
+	100.f,
+	TEXT("Cell size of the chase flow field, only read when a field is created."));
+
+static TAutoConsoleVariable<int32> CVarEnemyAIFlowFieldHalfExtent(
+	TEXT("slash.AI.FlowFieldHalfExtent"),
+	40,
+	TEXT("Number of cells the chase flow field extends on each side of the target, only read when a field is created."));
+
+static TAutoConsoleVariable<bool> CVarAnimBudget(
+	TEXT("slash.Anim.Budget"),
+	true,
+	TEXT("Enable the animation budget allocator for enemy meshes when the world starts. When off enemy meshes fall back to screen size update rate optimization."));
+
+static TAutoConsoleVariable<float> CVarAnimBudgetMs(
+	TEXT("slash.Anim.BudgetMs"),
+	1.5f,
+	TEXT("Game thread time in ms all budgeted skeletal meshes may take per frame before the least significant enemies are throttled. Read when the world starts."));
+
+// flow fields nobody chased for this many frames are thrown away along with their walkability cache
+static constexpr uint32 FlowFieldExpiryFrames = 600;
+
+// below this many enemies the ParallelFor overhead is not worth it
+static constexpr int32 MinEnemiesForParallelEvaluate = 64;
+
+// enemies overdue by this many intervals are updated regardless of the budget so none can starve
+static constexpr uint32 MaxMissedIntervals = 4;
+
+void UEnemyAISubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	++FrameCounter;
+	SET_DWORD_STAT(STAT_EnemyAIRegistered, Enemies.Num());
+
+	ScheduleUpdates();
+	NumUpdatedLastFrame = UpdateList.Num();
+	SET_DWORD_STAT(STAT_EnemyAIUpdated, NumUpdatedLastFrame);
+
+	if (CVarEnemyAIShowStats.GetValueOnGameThread() && GEngine)
+	{
+		GEngine->AddOnScreenDebugMessage(2, 0.f, FColor::Green, FString::Printf(TEXT("Enemy AI: %d / %d updated"), NumUpdatedLastFrame, Enemies.Num()));
+	}
+	if (UpdateList.Num() == 0)
+	{
+		SteerChasingEnemies();
+		PushAnimSnapshots();
+		UpdateAnimSignificance();
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	GatherEnemyState();
+	EvaluateDecisions();
+	ApplyCommands();
+	const double UpdateCost = (FPlatformTime::Seconds() - StartTime) / UpdateList.Num();
+
+	AverageUpdateCostSeconds = AverageUpdateCostSeconds > 0.0 ? FMath::Lerp(AverageUpdateCostSeconds, UpdateCost, 0.1) : UpdateCost;
+
+	// steering is movement, so it runs every frame for every chasing enemy regardless of its update bucket
+	SteerChasingEnemies();
+	PushAnimSnapshots();
+	UpdateAnimSignificance();
+}
+
+void UEnemyAISubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(&InWorld))
+	{
+		FAnimationBudgetAllocatorParameters Parameters;
+		Parameters.BudgetInMs = FMath::Max(CVarAnimBudgetMs.GetValueOnGameThread(), 0.1f);
+		Allocator->SetParameters(Parameters);
+		Allocator->SetEnabled(CVarAnimBudget.GetValueOnGameThread());
+	}
+
+	if (UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UEnemyAISubsystem::OnNavigationGenerated);
+	}
+}
+
+void UEnemyAISubsystem::OnNavigationGenerated(ANavigationData* NavData)
+{
+	for (auto& FlowField : FlowFields)
+	{
+		FlowField.Value->InvalidateWalkability();
+	}
+}
+
+TStatId UEnemyAISubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyAISubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyAISubsystem::IsFlowFieldChaseEnabled()
+{
+	return CVarEnemyAIFlowFieldChase.GetValueOnGameThread();
+}
+
+bool UEnemyAISubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyAISubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemies.Contains(Enemy)) return;
+
+	Enemies.Add(Enemy);
+	Positions.AddZeroed();
+	CombatTargetPositions.AddZeroed();
+	PatrolTargetPositions.AddZeroed();
+	HasCombatTarget.Add(false);
+	HasPatrolTarget.Add(false);
+	States.Add(Enemy->GetEnemyState());
+	// radii are design time values, so square them once here rather than every frame
+	CombatRadiiSquared.Add(FMath::Square(Enemy->GetCombatRadius()));
+	AttackRadiiSquared.Add(FMath::Square(Enemy->GetAttackRadius()));
+	PatrolRadiiSquared.Add(FMath::Square(Enemy->GetPatrolRadius()));
+	Commands.Add(EEnemyAICommand::EEAC_None);
+	// stagger the round robin so enemies registered on the same frame don't all update together
+	LastUpdateFrames.Add(FrameCounter - (uint32)Enemies.Num());
+	AnimInstances.Add(Cast<UEnemyAnimInstance>(Enemy->GetMesh()->GetAnimInstance()));
+	AnimSnapshots.AddDefaulted();
+}
+
+void UEnemyAISubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	const int32 Index = Enemies.Find(Enemy);
+	if (Index == INDEX_NONE) return;
+
+	if (bApplyingCommands)
+	{
+		// UpdateList holds indices, so leave the slot in place until the next schedule pass removes it
+		Enemies[Index] = nullptr;
+	}
+	else
+	{
+		RemoveEnemyAt(Index);
+	}
+}
+
+EEnemyAICommand UEnemyAISubsystem::EvaluateCombat(EEnemyState State, bool bHasTarget, double DistanceSquared, double CombatRadiusSquared, double AttackRadiusSquared)
+{
+	const bool bOutsideCombatRadius = !bHasTarget || DistanceSquared > CombatRadiusSquared;
+	const bool bInsideAttackRadius = bHasTarget && DistanceSquared <= AttackRadiusSquared;
+
+	if (bOutsideCombatRadius)
+	{
+		return EEnemyAICommand::EEAC_LoseInterest;
+	}
+	if (!bInsideAttackRadius && State != EEnemyState::EES_Chasing)
+	{
+		return EEnemyAICommand::EEAC_ChaseTarget;
+	}
+
+	const bool bCanAttack =
+		bInsideAttackRadius &&
+		State != EEnemyState::EES_Attacking &&
+		State != EEnemyState::EES_Engaged &&
+		State != EEnemyState::EES_Dead;
+	return bCanAttack ? EEnemyAICommand::EEAC_StartAttackTimer : EEnemyAICommand::EEAC_None;
+}
+
+EEnemyAICommand UEnemyAISubsystem::EvaluatePatrol(bool bHasPatrolTarget, double DistanceSquared, double PatrolRadiusSquared)
+{
+	if (bHasPatrolTarget && DistanceSquared <= PatrolRadiusSquared)
+	{
+		return EEnemyAICommand::EEAC_PatrolTargetReached;
+	}
+	return EEnemyAICommand::EEAC_None;
+}
+
+EEnemyAIBucket UEnemyAISubsystem::ClassifyEnemy(const AEnemy* Enemy, const FVector& PlayerLocation, bool bHasPlayer) const
+{
+	const EEnemyState State = Enemy->GetEnemyState();
+	if (State == EEnemyState::EES_Attacking || State == EEnemyState::EES_Engaged)
+	{
+		return EEnemyAIBucket::EEAB_Critical;
+	}
+	if (!bHasPlayer) return EEnemyAIBucket::EEAB_Far;
+
+	const double DistanceSquared = FVector::DistSquared(Enemy->GetActorLocation(), PlayerLocation);
+	int32 Bucket = (int32)EEnemyAIBucket::EEAB_Near;
+	if (DistanceSquared > FMath::Square(CVarEnemyAIFarDistance.GetValueOnGameThread()))
+	{
+		Bucket = (int32)EEnemyAIBucket::EEAB_Far;
+	}
+	else if (DistanceSquared > FMath::Square(CVarEnemyAINearDistance.GetValueOnGameThread()))
+	{
+		Bucket = (int32)EEnemyAIBucket::EEAB_Mid;
+	}
+
+	// enemies nobody can see drop one bucket further
+	if (!Enemy->WasRecentlyRendered(0.2f))
+	{
+		Bucket = FMath::Min(Bucket + 1, (int32)EEnemyAIBucket::EEAB_Far);
+	}
+	return (EEnemyAIBucket)Bucket;
+}
+
+void UEnemyAISubsystem::ScheduleUpdates()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAISchedule);
+
+	UpdateList.Reset();
+	for (TArray<int32>& Due : DueByBucket)
+	{
+		Due.Reset();
+	}
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+	const uint32 Intervals[(int32)EEnemyAIBucket::EEAB_MAX] =
+	{
+		1,
+		1,
+		(uint32)FMath::Max(CVarEnemyAIMidInterval.GetValueOnGameThread(), 1),
+		(uint32)FMath::Max(CVarEnemyAIFarInterval.GetValueOnGameThread(), 1)
+	};
+
+	// purge destroyed or unregistered slots first, RemoveEnemyAt swaps indices around
+	for (int32 Index = Enemies.Num() - 1; Index >= 0; --Index)
+	{
+		if (!IsValid(Enemies[Index]))
+		{
+			RemoveEnemyAt(Index);
+		}
+	}
+
+	for (int32 Index = 0; Index < Enemies.Num(); ++Index)
+	{
+		const AEnemy* Enemy = Enemies[Index];
+		if (Enemy->GetEnemyState() == EEnemyState::EES_Dead) continue;
+
+		EEnemyAIBucket Bucket = ClassifyEnemy(Enemy, PlayerLocation, Player != nullptr);
+		const uint32 Interval = Intervals[(int32)Bucket];
+		const uint32 FramesSinceUpdate = FrameCounter - LastUpdateFrames[Index];
+		if (FramesSinceUpdate < Interval) continue;
+
+		if (FramesSinceUpdate >= Interval * MaxMissedIntervals)
+		{
+			Bucket = EEnemyAIBucket::EEAB_Critical;
+		}
+		DueByBucket[(int32)Bucket].Add(Index);
+	}
+
+	// critical enemies always update, the rest are taken nearest bucket first until the budget is spent
+	const float BudgetMs = CVarEnemyAIBudgetMs.GetValueOnGameThread();
+	int32 MaxBudgetedUpdates = MAX_int32;
+	if (BudgetMs > 0.f && AverageUpdateCostSeconds > 0.0)
+	{
+		MaxBudgetedUpdates = FMath::Max(1, FMath::FloorToInt32((BudgetMs / 1000.0) / AverageUpdateCostSeconds));
+	}
+
+	UpdateList.Append(DueByBucket[(int32)EEnemyAIBucket::EEAB_Critical]);
+	for (int32 Bucket = (int32)EEnemyAIBucket::EEAB_Near; Bucket < (int32)EEnemyAIBucket::EEAB_MAX; ++Bucket)
+	{
+		const TArray<int32>& Due = DueByBucket[Bucket];
+		const int32 NumToTake = FMath::Min(Due.Num(), MaxBudgetedUpdates);
+		UpdateList.Append(Due.GetData(), NumToTake);
+		MaxBudgetedUpdates -= NumToTake;
+		if (MaxBudgetedUpdates <= 0) break;
+	}
+
+	for (const int32 Index : UpdateList)
+	{
+		LastUpdateFrames[Index] = FrameCounter;
+	}
+}
+
+void UEnemyAISubsystem::GatherEnemyState()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAIGather);
+
+	// actor reads have to happen on the game thread, so copy everything the decision pass needs
+	for (const int32 Index : UpdateList)
+	{
+		const AEnemy* Enemy = Enemies[Index];
+		Positions[Index] = Enemy->GetActorLocation();
+		States[Index] = Enemy->GetEnemyState();
+
+		const AActor* CombatTarget = Enemy->GetCombatTarget();
+		HasCombatTarget[Index] = CombatTarget != nullptr;
+		if (CombatTarget) CombatTargetPositions[Index] = CombatTarget->GetActorLocation();
+
+		const AActor* PatrolTarget = Enemy->GetPatrolTarget();
+		HasPatrolTarget[Index] = PatrolTarget != nullptr;
+		if (PatrolTarget) PatrolTargetPositions[Index] = PatrolTarget->GetActorLocation();
+	}
+}
+
+void UEnemyAISubsystem::EvaluateDecisions()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAIEvaluate);
+
+	const int32 NumToUpdate = UpdateList.Num();
+	ParallelFor(NumToUpdate, [this](int32 ListIndex)
+	{
+		const int32 Index = UpdateList[ListIndex];
+		const EEnemyState State = States[Index];
+		if (State == EEnemyState::EES_Dead)
+		{
+			Commands[Index] = EEnemyAICommand::EEAC_None;
+		}
+		else if (State > EEnemyState::EES_Patrolling)
+		{
+			const double DistanceSquared = FVector::DistSquared(Positions[Index], CombatTargetPositions[Index]);
+			Commands[Index] = EvaluateCombat(State, HasCombatTarget[Index], DistanceSquared, CombatRadiiSquared[Index], AttackRadiiSquared[Index]);
+		}
+		else
+		{
+			const double DistanceSquared = FVector::DistSquared(Positions[Index], PatrolTargetPositions[Index]);
+			Commands[Index] = EvaluatePatrol(HasPatrolTarget[Index], DistanceSquared, PatrolRadiiSquared[Index]);
+		}
+	}, NumToUpdate < MinEnemiesForParallelEvaluate ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UEnemyAISubsystem::ApplyCommands()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAIApply);
+
+	// a command may kill or unregister an enemy, which only nulls its slot while this flag is set
+	TGuardValue<bool> ApplyingGuard(bApplyingCommands, true);
+	for (const int32 Index : UpdateList)
+	{
+		AEnemy* Enemy = Enemies[Index];
+		if (Enemy && Commands[Index] != EEnemyAICommand::EEAC_None)
+		{
+			Enemy->ApplyAICommand(Commands[Index]);
+		}
+	}
+}
+
+void UEnemyAISubsystem::SteerChasingEnemies()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyChaseSteering);
+
+	if (!IsFlowFieldChaseEnabled())
+	{
+		// switched off at runtime, chasers steered by the field won't get a new chase command, so path them from here
+		for (AEnemy* Enemy : Enemies)
+		{
+			if (IsValid(Enemy) && Enemy->GetEnemyState() == EEnemyState::EES_Chasing)
+			{
+				Enemy->ChaseByPathfinding();
+			}
+		}
+		FlowFields.Reset();
+		return;
+	}
+
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSystem ? NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	int32 NumFlowFieldChasers = 0;
+
+	for (AEnemy* Enemy : Enemies)
+	{
+		if (!IsValid(Enemy) || Enemy->GetEnemyState() != EEnemyState::EES_Chasing) continue;
+
+		AActor* Target = Enemy->GetCombatTarget();
+		if (Target == nullptr) continue;
+
+		TUniquePtr<FEnemyFlowField>& FlowField = FlowFields.FindOrAdd(Target);
+		if (!FlowField.IsValid())
+		{
+			FlowField = MakeUnique<FEnemyFlowField>(CVarEnemyAIFlowFieldCellSize.GetValueOnGameThread(), FMath::Max(CVarEnemyAIFlowFieldHalfExtent.GetValueOnGameThread(), 1));
+		}
+		// only the first chaser of a target each frame brings its field up to date
+		if (FlowField->LastUsedFrame != FrameCounter)
+		{
+			FlowField->LastUsedFrame = FrameCounter;
+			if (FlowField->Update(Target->GetActorLocation(), NavSystem, NavData))
+			{
+				INC_DWORD_STAT(STAT_FlowFieldRebuilds);
+			}
+		}
+
+		FVector Direction;
+		if (FlowField->Sample(Enemy->GetActorLocation(), Direction))
+		{
+			Enemy->SteerChase(Direction);
+			++NumFlowFieldChasers;
+		}
+		else
+		{
+			// outside the field or cut off from the target, fall back to a regular path query
+			Enemy->ChaseByPathfinding();
+		}
+	}
+
+	for (auto It = FlowFields.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ResolveObjectPtr() == nullptr || FrameCounter - It.Value()->LastUsedFrame > FlowFieldExpiryFrames)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EnemyFlowFieldChasers, NumFlowFieldChasers);
+}
+
+void UEnemyAISubsystem::RemoveEnemyAt(int32 Index)
+{
+	Enemies.RemoveAtSwap(Index);
+	Positions.RemoveAtSwap(Index);
+	CombatTargetPositions.RemoveAtSwap(Index);
+	PatrolTargetPositions.RemoveAtSwap(Index);
+	HasCombatTarget.RemoveAtSwap(Index);
+	HasPatrolTarget.RemoveAtSwap(Index);
+	States.RemoveAtSwap(Index);
+	CombatRadiiSquared.RemoveAtSwap(Index);
+	AttackRadiiSquared.RemoveAtSwap(Index);
+	PatrolRadiiSquared.RemoveAtSwap(Index);
+	Commands.RemoveAtSwap(Index);
+	LastUpdateFrames.RemoveAtSwap(Index);
+	AnimInstances.RemoveAtSwap(Index);
+	AnimSnapshots.RemoveAtSwap(Index);
+}
+
+void UEnemyAISubsystem::PushAnimSnapshots()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAnimSnapshots);
+
+	// every enemy, not just this frame's update list, ground speed changes whatever bucket the enemy is in
+	int32 NumPushed = 0;
+	for (int32 Index = 0; Index < Enemies.Num(); ++Index)
+	{
+		UEnemyAnimInstance* AnimInstance = AnimInstances[Index].Get();
+		const AEnemy* Enemy = Enemies[Index];
+		if (AnimInstance == nullptr || Enemy == nullptr) continue;
+
+		FEnemyAnimSnapshot Snapshot;
+		Snapshot.EnemyState = Enemy->GetEnemyState();
+		Snapshot.GroundSpeed = Enemy->GetCharacterMovement()->Velocity.Size2D();
+		Snapshot.DeathPose = Enemy->GetDeathPose();
+		Snapshot.bLocomotionOnly = Snapshot.EnemyState == EEnemyState::EES_Patrolling && !AnimInstance->IsAnyMontagePlaying();
+
+		if (Snapshot == AnimSnapshots[Index]) continue;
+		AnimInstance->PushSnapshot(Snapshot);
+		AnimSnapshots[Index] = Snapshot;
+		++NumPushed;
+	}
+	SET_DWORD_STAT(STAT_EnemyAnimSnapshotsPushed, NumPushed);
+}
+
+void UEnemyAISubsystem::UpdateAnimSignificance()
+{
+	IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(GetWorld());
+	const bool bBudgetEnabled = Allocator && Allocator->GetEnabled();
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+	const double FarDistanceSquared = FMath::Max(FMath::Square(CVarEnemyAIFarDistance.GetValueOnGameThread()), 1.0);
+
+	for (const AEnemy* Enemy : Enemies)
+	{
+		if (Enemy == nullptr) continue;
+		USkeletalMeshComponentBudgeted* Mesh = Cast<USkeletalMeshComponentBudgeted>(Enemy->GetMesh());
+		if (Mesh == nullptr) continue;
+
+		// the weapon sockets have to be where the animation says while a swing can land
+		const EEnemyState State = Enemy->GetEnemyState();
+		const bool bFullRate = State == EEnemyState::EES_Attacking || State == EEnemyState::EES_Engaged;
+
+		if (!bBudgetEnabled)
+		{
+			Mesh->bEnableUpdateRateOptimizations = !bFullRate;
+			continue;
+		}
+
+		// 1 next to the player down to 0 at the far distance, halved when off screen, so far background patrols degrade first
+		float Significance = 0.f;
+		if (State != EEnemyState::EES_Dead && Player)
+		{
+			const double DistanceSquared = FVector::DistSquared(Enemy->GetActorLocation(), PlayerLocation);
+			Significance = 1.f - (float)FMath::Min(DistanceSquared / FarDistanceSquared, 1.0);
+			if (!Enemy->WasRecentlyRendered(0.2f))
+			{
+				Significance *= 0.5f;
+			}
+		}
+		if (bFullRate)
+		{
+			Significance = 2.f;
+		}
+		Allocator->SetComponentSignificance(Mesh, Significance, bFullRate, bFullRate, !bFullRate);
+	}
+}
@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/EnemyFlowField.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+static const FIntPoint NeighbourOffsets[8] =
+{
+	FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1),
+	FIntPoint(1, 1), FIntPoint(1, -1), FIntPoint(-1, 1), FIntPoint(-1, -1)
+};
+
+static const float NeighbourCosts[8] = { 1.f, 1.f, 1.f, 1.f, UE_SQRT_2, UE_SQRT_2, UE_SQRT_2, UE_SQRT_2 };
+
+// goal heights are bucketed into bands this tall, cells are projected from the middle of the goal's band
+static constexpr double HeightBandSize = 400.0;
+static constexpr double ProjectionHalfHeight = 250.0;
+
+FEnemyFlowField::FEnemyFlowField(double InCellSize, int32 InHalfExtentCells)
+	: CellSize(InCellSize)
+	, HalfExtentCells(InHalfExtentCells)
+	, GridWidth(InHalfExtentCells * 2 + 1)
+{
+	const int32 NumCells = GridWidth * GridWidth;
+	Walkable.SetNumZeroed(NumCells);
+	PreviousWalkable.SetNumZeroed(NumCells);
+	Costs.SetNumUninitialized(NumCells);
+	Directions.SetNumZeroed(NumCells);
+}
+
+bool FEnemyFlowField::Update(const FVector& GoalLocation, UNavigationSystemV1* NavSystem, const ANavigationData* NavData)
+{
+	const FIntPoint NewGoalCell = GetCell(GoalLocation);
+	const int32 NewHeightBand = FMath::FloorToInt32(GoalLocation.Z / HeightBandSize);
+	if (bHasGoal && !bWalkableStale && NewGoalCell == GoalCell && NewHeightBand == HeightBand) return false;
+	if (NavSystem == nullptr || NavData == nullptr) return false;
+
+	if (NewHeightBand != HeightBand)
+	{
+		// a different floor or the other end of a ramp, none of the current answers apply
+		HeightBand = NewHeightBand;
+		bWalkableStale = true;
+	}
+
+	GoalCell = NewGoalCell;
+	bHasGoal = true;
+	if (bWalkableStale || IsNearWindowEdge(GoalCell))
+	{
+		MoveWindow(GoalCell - FIntPoint(HalfExtentCells, HalfExtentCells), NavSystem, NavData);
+	}
+
+	Integrate();
+	return true;
+}
+
+void FEnemyFlowField::InvalidateWalkability()
+{
+	WalkableCache.Reset();
+	bWalkableStale = true;
+}
+
+bool FEnemyFlowField::IsNearWindowEdge(const FIntPoint& Cell) const
+{
+	// re-centre once the goal is in the outer quarter, so enemies behind it still have room in the field
+	const int32 Margin = FMath::Max(HalfExtentCells / 2, 1);
+	const FIntPoint Local = Cell - Origin;
+	return Local.X < Margin || Local.Y < Margin || Local.X >= GridWidth - Margin || Local.Y >= GridWidth - Margin;
+}
+
+void FEnemyFlowField::MoveWindow(const FIntPoint& NewOrigin, UNavigationSystemV1* NavSystem, const ANavigationData* NavData)
+{
+	// cells inside both windows keep their answer, only the newly uncovered strip is looked up
+	const bool bCanReuse = !bWalkableStale;
+	const FIntPoint OldOrigin = Origin;
+	Swap(Walkable, PreviousWalkable);
+	Origin = NewOrigin;
+
+	for (int32 Y = 0; Y < GridWidth; ++Y)
+	{
+		for (int32 X = 0; X < GridWidth; ++X)
+		{
+			const FIntPoint Cell = Origin + FIntPoint(X, Y);
+			const FIntPoint OldLocal = Cell - OldOrigin;
+			const bool bInOldWindow = OldLocal.X >= 0 && OldLocal.Y >= 0 && OldLocal.X < GridWidth && OldLocal.Y < GridWidth;
+
+			Walkable[Y * GridWidth + X] = bCanReuse && bInOldWindow
+				? PreviousWalkable[OldLocal.Y * GridWidth + OldLocal.X]
+				: IsCellWalkable(Cell, NavSystem, NavData);
+		}
+	}
+	bWalkableStale = false;
+}
+
+bool FEnemyFlowField::Sample(const FVector& Location, FVector& OutDirection) const
+{
+	if (!bHasGoal) return false;
+
+	const int32 Index = ToLocalIndex(GetCell(Location));
+	if (Index == INDEX_NONE || Costs[Index] == TNumericLimits<float>::Max()) return false;
+
+	const FVector2f& Direction = Directions[Index];
+	OutDirection = FVector(Direction.X, Direction.Y, 0.f);
+	return true;
+}
+
+FIntPoint FEnemyFlowField::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+bool FEnemyFlowField::IsCellWalkable(const FIntPoint& Cell, UNavigationSystemV1* NavSystem, const ANavigationData* NavData)
+{
+	const FIntVector Key(Cell.X, Cell.Y, HeightBand);
+	if (const bool* Cached = WalkableCache.Find(Key))
+	{
+		return *Cached;
+	}
+
+	const FVector CellCentre((Cell.X + 0.5) * CellSize, (Cell.Y + 0.5) * CellSize, (HeightBand + 0.5) * HeightBandSize);
+	const FVector QueryExtent(CellSize * 0.5, CellSize * 0.5, ProjectionHalfHeight);
+	FNavLocation Projected;
+	const bool bWalkable = NavSystem->ProjectPointToNavigation(CellCentre, Projected, QueryExtent, NavData);
+
+	WalkableCache.Add(Key, bWalkable);
+	return bWalkable;
+}
+
+int32 FEnemyFlowField::ToLocalIndex(const FIntPoint& Cell) const
+{
+	const FIntPoint Local = Cell - Origin;
+	if (Local.X < 0 || Local.Y < 0 || Local.X >= GridWidth || Local.Y >= GridWidth) return INDEX_NONE;
+	return Local.Y * GridWidth + Local.X;
+}
+
+void FEnemyFlowField::Integrate()
+{
+	for (float& Cost : Costs)
+	{
+		Cost = TNumericLimits<float>::Max();
+	}
+
+	// Dijkstra out from the goal cell, then every cell points at its cheapest neighbour
+	const int32 GoalIndex = ToLocalIndex(GoalCell);
+	Costs[GoalIndex] = 0.f;
+	OpenList.Reset();
+	OpenList.HeapPush(TPair<float, int32>(0.f, GoalIndex), TLess<TPair<float, int32>>());
+
+	while (OpenList.Num() > 0)
+	{
+		TPair<float, int32> Current;
+		OpenList.HeapPop(Current, TLess<TPair<float, int32>>());
+		if (Current.Key > Costs[Current.Value]) continue;
+
+		const FIntPoint CurrentCell(Current.Value % GridWidth, Current.Value / GridWidth);
+		for (int32 Neighbour = 0; Neighbour < 8; ++Neighbour)
+		{
+			const FIntPoint Next = CurrentCell + NeighbourOffsets[Neighbour];
+			if (Next.X < 0 || Next.Y < 0 || Next.X >= GridWidth || Next.Y >= GridWidth) continue;
+
+			const int32 NextIndex = Next.Y * GridWidth + Next.X;
+			if (!Walkable[NextIndex]) continue;
+
+			// don't cut diagonally past a blocked corner
+			if (Neighbour >= 4)
+			{
+				const bool bCornerX = Walkable[CurrentCell.Y * GridWidth + Next.X];
+				const bool bCornerY = Walkable[Next.Y * GridWidth + CurrentCell.X];
+				if (!bCornerX || !bCornerY) continue;
+			}
+
+			const float NewCost = Current.Key + NeighbourCosts[Neighbour];
+			if (NewCost < Costs[NextIndex])
+			{
+				Costs[NextIndex] = NewCost;
+				OpenList.HeapPush(TPair<float, int32>(NewCost, NextIndex), TLess<TPair<float, int32>>());
+			}
+		}
+	}
+
+	for (int32 Index = 0; Index < Costs.Num(); ++Index)
+	{
+		Directions[Index] = FVector2f::ZeroVector;
+		if (Costs[Index] == TNumericLimits<float>::Max() || Index == GoalIndex) continue;
+
+		const FIntPoint Cell(Index % GridWidth, Index / GridWidth);
+		float BestCost = Costs[Index];
+		for (int32 Neighbour = 0; Neighbour < 8; ++Neighbour)
+		{
+			const FIntPoint Next = Cell + NeighbourOffsets[Neighbour];
+			if (Next.X < 0 || Next.Y < 0 || Next.X >= GridWidth || Next.Y >= GridWidth) continue;
+
+			const float NextCost = Costs[Next.Y * GridWidth + Next.X];
+			if (NextCost < BestCost)
+			{
+				BestCost = NextCost;
+				Directions[Index] = FVector2f(NeighbourOffsets[Neighbour]).GetSafeNormal();
+			}
+		}
+	}
+}
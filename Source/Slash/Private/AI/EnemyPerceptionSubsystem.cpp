@@ -0,0 +1,362 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/EnemyPerceptionSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Hash/CityHash.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Perception"), STAT_EnemyPerception, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Candidates"), STAT_PerceptionCandidates, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Sight Traces"), STAT_PerceptionSightTraces, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Sight Cache Hits"), STAT_PerceptionSightCacheHits, STATGROUP_Slash);
+
+static TAutoConsoleVariable<float> CVarPerceptionInterval(
+	TEXT("slash.Perception.Interval"),
+	0.5f,
+	TEXT("Seconds between enemy perception passes, same as the old UPawnSensingComponent SensingInterval."));
+
+static TAutoConsoleVariable<float> CVarPerceptionCellSize(
+	TEXT("slash.Perception.CellSize"),
+	2000.f,
+	TEXT("Size of a spatial hash cell used to find targets near an enemy."));
+
+static TAutoConsoleVariable<float> CVarSightCacheCellSize(
+	TEXT("slash.Perception.SightCacheCellSize"),
+	200.f,
+	TEXT("Enemies and targets within the same cells of this size share a cached line of sight answer."));
+
+static TAutoConsoleVariable<float> CVarSightCacheLifetime(
+	TEXT("slash.Perception.SightCacheLifetime"),
+	0.5f,
+	TEXT("Seconds a cached line of sight answer stays valid."));
+
+static constexpr int32 MinObserversForParallelSearch = 32;
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// traces submitted last frame have finished off the game thread by now
+	if (PendingTraces.Num() > 0)
+	{
+		ConsumeSightTraces();
+	}
+
+	TimeSinceLastUpdate += DeltaTime;
+	if (TimeSinceLastUpdate < CVarPerceptionInterval.GetValueOnGameThread()) return;
+	TimeSinceLastUpdate = 0.f;
+
+	UpdatePerception();
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool UEnemyPerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyPerceptionSubsystem::RegisterObserver(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) return;
+	for (const FPerceptionObserver& Observer : Observers)
+	{
+		if (Observer.Enemy == Enemy) return;
+	}
+
+	FPerceptionObserver& Observer = Observers.AddDefaulted_GetRef();
+	Observer.Enemy = Enemy;
+	Observer.SightRadiusSquared = FMath::Square(Enemy->GetSightRadius());
+	Observer.CosPeripheralAngle = FMath::Cos(FMath::DegreesToRadians(Enemy->GetPeripheralVisionAngle()));
+}
+
+void UEnemyPerceptionSubsystem::UnregisterObserver(AEnemy* Enemy)
+{
+	Observers.RemoveAllSwap([Enemy](const FPerceptionObserver& Observer) { return Observer.Enemy == Enemy; });
+}
+
+void UEnemyPerceptionSubsystem::ForgetSeenPawns(AEnemy* Enemy)
+{
+	for (FPerceptionObserver& Observer : Observers)
+	{
+		if (Observer.Enemy == Enemy)
+		{
+			Observer.SeenPawns.Reset();
+			Observer.PendingSights.Reset();
+			return;
+		}
+	}
+}
+
+void UEnemyPerceptionSubsystem::RegisterTarget(APawn* Pawn)
+{
+	if (Pawn == nullptr) return;
+	for (const FPerceptionTarget& Target : Targets)
+	{
+		if (Target.Pawn == Pawn) return;
+	}
+
+	FPerceptionTarget& Target = Targets.AddDefaulted_GetRef();
+	Target.Pawn = Pawn;
+}
+
+void UEnemyPerceptionSubsystem::UnregisterTarget(APawn* Pawn)
+{
+	Targets.RemoveAllSwap([Pawn](const FPerceptionTarget& Target) { return Target.Pawn == Pawn; });
+}
+
+void UEnemyPerceptionSubsystem::UpdatePerception()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPerception);
+
+	GatherObservers();
+	GatherTargets();
+	BuildTargetGrid();
+	FindCandidates();
+	ResolveSightAndNotify();
+}
+
+void UEnemyPerceptionSubsystem::GatherObservers()
+{
+	for (int32 Index = Observers.Num() - 1; Index >= 0; --Index)
+	{
+		FPerceptionObserver& Observer = Observers[Index];
+		const AEnemy* Enemy = Observer.Enemy.Get();
+		if (Enemy == nullptr)
+		{
+			Observers.RemoveAtSwap(Index);
+			continue;
+		}
+
+		Observer.bActive = Enemy->GetEnemyState() != EEnemyState::EES_Dead;
+		Observer.EyeLocation = Enemy->GetPawnViewLocation();
+		Observer.Forward = Enemy->GetActorForwardVector();
+	}
+}
+
+void UEnemyPerceptionSubsystem::GatherTargets()
+{
+	for (int32 Index = Targets.Num() - 1; Index >= 0; --Index)
+	{
+		FPerceptionTarget& Target = Targets[Index];
+		const APawn* Pawn = Target.Pawn.Get();
+		if (Pawn == nullptr)
+		{
+			Targets.RemoveAtSwap(Index);
+			continue;
+		}
+
+		Target.EyeLocation = Pawn->GetPawnViewLocation();
+		Target.bSensable = ICombatTeamInterface::IsEngageable(Pawn);
+	}
+}
+
+void UEnemyPerceptionSubsystem::BuildTargetGrid()
+{
+	CellSize = FMath::Max(CVarPerceptionCellSize.GetValueOnGameThread(), 100.f);
+
+	// keep the cell allocations around between passes, the same few cells get reused
+	for (auto& Cell : TargetGrid)
+	{
+		Cell.Value.Reset();
+	}
+
+	for (int32 Index = 0; Index < Targets.Num(); ++Index)
+	{
+		if (Targets[Index].bSensable)
+		{
+			TargetGrid.FindOrAdd(GetCell(Targets[Index].EyeLocation)).Add(Index);
+		}
+	}
+}
+
+void UEnemyPerceptionSubsystem::FindCandidates()
+{
+	const int32 NumObservers = Observers.Num();
+	ParallelFor(NumObservers, [this](int32 Index)
+	{
+		FPerceptionObserver& Observer = Observers[Index];
+		Observer.Candidates.Reset();
+		if (!Observer.bActive) return;
+
+		const double SightRadius = FMath::Sqrt(Observer.SightRadiusSquared);
+		const FIntPoint MinCell = GetCell(Observer.EyeLocation - FVector(SightRadius));
+		const FIntPoint MaxCell = GetCell(Observer.EyeLocation + FVector(SightRadius));
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				const auto* Cell = TargetGrid.Find(FIntPoint(X, Y));
+				if (Cell == nullptr) continue;
+
+				for (const int32 TargetIndex : *Cell)
+				{
+					const FVector ToTarget = Targets[TargetIndex].EyeLocation - Observer.EyeLocation;
+					const double DistanceSquared = ToTarget.SizeSquared();
+					if (DistanceSquared > Observer.SightRadiusSquared) continue;
+
+					// inside the peripheral vision cone, compared on cosines to avoid the Acos
+					const double Dot = FVector::DotProduct(Observer.Forward, ToTarget);
+					if (Dot >= Observer.CosPeripheralAngle * FMath::Sqrt(DistanceSquared))
+					{
+						Observer.Candidates.Add(TargetIndex);
+					}
+				}
+			}
+		}
+	}, NumObservers < MinObserversForParallelSearch ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UEnemyPerceptionSubsystem::ResolveSightAndNotify()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	PurgeSightCache(Now);
+
+	int32 NumCandidates = 0;
+	int32 NumCacheHits = 0;
+
+	for (FPerceptionObserver& Observer : Observers)
+	{
+		if (!Observer.Enemy.IsValid()) continue;
+
+		// forget pawns that left the cone, without notifying
+		Observer.SeenPawns.RemoveAll([this, &Observer](const TWeakObjectPtr<APawn>& Seen)
+		{
+			for (const int32 TargetIndex : Observer.Candidates)
+			{
+				if (Targets[TargetIndex].Pawn == Seen) return false;
+			}
+			return true;
+		});
+		Observer.PendingSights.Reset();
+
+		for (const int32 TargetIndex : Observer.Candidates)
+		{
+			++NumCandidates;
+			const FPerceptionTarget& Target = Targets[TargetIndex];
+			const uint64 CacheKey = MakeSightCacheKey(Observer.EyeLocation, Target.EyeLocation);
+
+			if (const FSightCacheEntry* Cached = SightCache.Find(CacheKey))
+			{
+				++NumCacheHits;
+				ApplySight(Observer, Target.Pawn.Get(), Cached->bVisible);
+				continue;
+			}
+
+			// one trace per cell pair, every other pair in the same cells waits on it
+			if (!PendingTraceKeys.Contains(CacheKey))
+			{
+				SubmitSightTrace(Observer, Target, CacheKey);
+			}
+			Observer.PendingSights.Add({ Target.Pawn, CacheKey });
+		}
+	}
+
+	SET_DWORD_STAT(STAT_PerceptionCandidates, NumCandidates);
+	SET_DWORD_STAT(STAT_PerceptionSightTraces, PendingTraces.Num());
+	SET_DWORD_STAT(STAT_PerceptionSightCacheHits, NumCacheHits);
+}
+
+void UEnemyPerceptionSubsystem::SubmitSightTrace(const FPerceptionObserver& Observer, const FPerceptionTarget& Target, uint64 CacheKey)
+{
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(EnemySight), true, Observer.Enemy.Get());
+	Params.AddIgnoredActor(Target.Pawn.Get());
+
+	const FTraceHandle Handle = GetWorld()->AsyncLineTraceByChannel(
+		EAsyncTraceType::Single,
+		Observer.EyeLocation,
+		Target.EyeLocation,
+		ECollisionChannel::ECC_Visibility,
+		Params);
+
+	PendingTraces.Emplace(Handle, CacheKey);
+	PendingTraceKeys.Add(CacheKey);
+}
+
+void UEnemyPerceptionSubsystem::ConsumeSightTraces()
+{
+	UWorld* World = GetWorld();
+	const double Now = World->GetTimeSeconds();
+
+	for (const TPair<FTraceHandle, uint64>& Pending : PendingTraces)
+	{
+		FTraceDatum Datum;
+		if (World->QueryTraceData(Pending.Key, Datum))
+		{
+			const bool bBlocked = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+			SightCache.Add(Pending.Value, { !bBlocked, Now });
+		}
+	}
+	PendingTraces.Reset();
+	PendingTraceKeys.Reset();
+
+	// a pair whose trace result got lost simply stays unresolved until the next pass
+	for (FPerceptionObserver& Observer : Observers)
+	{
+		for (const FPendingSight& Pending : Observer.PendingSights)
+		{
+			const FSightCacheEntry* Cached = SightCache.Find(Pending.CacheKey);
+			if (Cached && Pending.Pawn.IsValid())
+			{
+				ApplySight(Observer, Pending.Pawn.Get(), Cached->bVisible);
+			}
+		}
+		Observer.PendingSights.Reset();
+	}
+}
+
+void UEnemyPerceptionSubsystem::ApplySight(FPerceptionObserver& Observer, APawn* Pawn, bool bVisible)
+{
+	AEnemy* Enemy = Observer.Enemy.Get();
+	if (Enemy == nullptr || Pawn == nullptr) return;
+
+	const bool bAlreadySeen = Observer.SeenPawns.Contains(Pawn);
+	if (bVisible && !bAlreadySeen)
+	{
+		Observer.SeenPawns.Add(Pawn);
+		Enemy->PawnSeen(Pawn);
+	}
+	else if (!bVisible && bAlreadySeen)
+	{
+		Observer.SeenPawns.Remove(Pawn);
+	}
+}
+
+void UEnemyPerceptionSubsystem::PurgeSightCache(double Now)
+{
+	const double Lifetime = CVarSightCacheLifetime.GetValueOnGameThread();
+	for (auto It = SightCache.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().Time > Lifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+uint64 UEnemyPerceptionSubsystem::MakeSightCacheKey(const FVector& ObserverLocation, const FVector& TargetLocation) const
+{
+	const double SightCellSize = FMath::Max(CVarSightCacheCellSize.GetValueOnGameThread(), 1.f);
+	const int32 Cells[6] =
+	{
+		FMath::FloorToInt32(ObserverLocation.X / SightCellSize),
+		FMath::FloorToInt32(ObserverLocation.Y / SightCellSize),
+		FMath::FloorToInt32(ObserverLocation.Z / SightCellSize),
+		FMath::FloorToInt32(TargetLocation.X / SightCellSize),
+		FMath::FloorToInt32(TargetLocation.Y / SightCellSize),
+		FMath::FloorToInt32(TargetLocation.Z / SightCellSize)
+	};
+	return CityHash64(reinterpret_cast<const char*>(Cells), sizeof(Cells));
+}
+
+FIntPoint UEnemyPerceptionSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/PatrolRouteSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "EngineUtils.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Algo/Reverse.h"
+#include "Slash.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Patrol Routes Cached"), STAT_PatrolRoutesCached, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Patrol Path Queries Avoided"), STAT_PatrolPathQueriesAvoided, STATGROUP_Slash);
+
+void UPatrolRouteSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// collect every patrol point that is referenced together with another by the same enemy
+	for (TActorIterator<AEnemy> It(&InWorld); It; ++It)
+	{
+		AddRoutes(It->GetPatrolTargets());
+	}
+
+	UE_LOG(LogSlash, Log, TEXT("Patrol routes: cached %d paths between %d patrol points"), Routes.Num(), PatrolPoints.Num());
+}
+
+bool UPatrolRouteSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPatrolRouteSubsystem::AddRoutes(const TArray<AActor*>& Targets)
+{
+	for (int32 From = 0; From < Targets.Num(); ++From)
+	{
+		for (int32 To = From + 1; To < Targets.Num(); ++To)
+		{
+			if (Targets[From] == nullptr || Targets[To] == nullptr || Targets[From] == Targets[To]) continue;
+			BuildRoute(AddPatrolPoint(Targets[From]), AddPatrolPoint(Targets[To]));
+		}
+	}
+}
+
+bool UPatrolRouteSubsystem::GetRoutePoints(AActor* From, AActor* To, TArray<FVector>& OutPoints)
+{
+	if (From == nullptr || To == nullptr || From == To) return false;
+
+	bool bReversed = false;
+	const FPatrolRoute* Route = FindRoute(From, To, bReversed);
+	if (Route == nullptr)
+	{
+		BuildRoute(AddPatrolPoint(From), AddPatrolPoint(To));
+		Route = FindRoute(From, To, bReversed);
+		if (Route == nullptr) return false;
+	}
+
+	OutPoints.Reset(Route->NumPathPoints);
+	OutPoints.Append(&RoutePathPoints[Route->FirstPathPoint], Route->NumPathPoints);
+	if (bReversed)
+	{
+		Algo::Reverse(OutPoints);
+	}
+	return true;
+}
+
+void UPatrolRouteSubsystem::NotifyRouteFollowed()
+{
+	++NumPathQueriesAvoided;
+	INC_DWORD_STAT(STAT_PatrolPathQueriesAvoided);
+}
+
+float UPatrolRouteSubsystem::GetRouteCost(AActor* From, AActor* To) const
+{
+	bool bReversed = false;
+	const FPatrolRoute* Route = FindRoute(From, To, bReversed);
+	return Route ? Route->Cost : TNumericLimits<float>::Max();
+}
+
+int32 UPatrolRouteSubsystem::AddPatrolPoint(AActor* Point)
+{
+	if (const int32* Existing = PatrolPointIndices.Find(Point))
+	{
+		return *Existing;
+	}
+	const int32 Index = PatrolPoints.Add(Point);
+	PatrolPointIndices.Add(Point, Index);
+	return Index;
+}
+
+void UPatrolRouteSubsystem::BuildRoute(int32 From, int32 To)
+{
+	if (From > To) Swap(From, To);
+	const uint64 Key = MakeRouteKey(From, To);
+	if (RouteIndices.Contains(Key)) return;
+
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSystem ? NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (NavData == nullptr) return;
+
+	// remembered either way, a pair without a path would otherwise be queried again on every patrol leg
+	int32& RouteIndex = RouteIndices.Add(Key, INDEX_NONE);
+
+	const FVector Start = PatrolPoints[From]->GetActorLocation();
+	const FVector End = PatrolPoints[To]->GetActorLocation();
+	const FPathFindingQuery Query(nullptr, *NavData, Start, End);
+	const FPathFindingResult Result = NavSystem->FindPathSync(Query);
+	if (!Result.IsSuccessful() || !Result.Path.IsValid()) return;
+
+	const TArray<FNavPathPoint>& PathPoints = Result.Path->GetPathPoints();
+	FPatrolRoute& Route = Routes.AddDefaulted_GetRef();
+	Route.FirstPathPoint = RoutePathPoints.Num();
+	Route.NumPathPoints = PathPoints.Num();
+	Route.Cost = Result.Path->GetCost();
+	for (const FNavPathPoint& PathPoint : PathPoints)
+	{
+		RoutePathPoints.Add(PathPoint.Location);
+	}
+	RouteIndex = Routes.Num() - 1;
+	SET_DWORD_STAT(STAT_PatrolRoutesCached, Routes.Num());
+}
+
+const FPatrolRoute* UPatrolRouteSubsystem::FindRoute(AActor* From, AActor* To, bool& bOutReversed) const
+{
+	const int32* FromIndex = PatrolPointIndices.Find(From);
+	const int32* ToIndex = PatrolPointIndices.Find(To);
+	if (FromIndex == nullptr || ToIndex == nullptr) return nullptr;
+
+	bOutReversed = *FromIndex > *ToIndex;
+	const int32* RouteIndex = bOutReversed ? RouteIndices.Find(MakeRouteKey(*ToIndex, *FromIndex)) : RouteIndices.Find(MakeRouteKey(*FromIndex, *ToIndex));
+	return RouteIndex && *RouteIndex != INDEX_NONE ? &Routes[*RouteIndex] : nullptr;
+}
+
+uint64 UPatrolRouteSubsystem::MakeRouteKey(int32 From, int32 To)
+{
+	return ((uint64)(uint32)From << 32) | (uint64)(uint32)To;
+}
@@ -5,6 +5,8 @@
 #include "GeometryCollection/GeometryCollectionComponent.h"
 #include "Items/Treasure.h"
 #include "Components/CapsuleComponent.h"
+#include "Items/SpawnQueueSubsystem.h"
+#include "Combat/ImpactFieldSubsystem.h"
 
 // Sets default values
 ABreakableActor::ABreakableActor()
@@ -31,7 +33,22 @@ ABreakableActor::ABreakableActor()
 void ABreakableActor::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// weapon impacts only emit fields near a registered breakable
+	if (UImpactFieldSubsystem* ImpactFields = GetWorld()->GetSubsystem<UImpactFieldSubsystem>())
+	{
+		ImpactFields->RegisterBreakable(this);
+	}
+}
+
+void ABreakableActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UImpactFieldSubsystem* ImpactFields = GetWorld()->GetSubsystem<UImpactFieldSubsystem>())
+	{
+		ImpactFields->UnregisterBreakable(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ABreakableActor::Tick(float DeltaTime)
@@ -46,12 +63,12 @@ void ABreakableActor::GetHit_Implementation(const FVector& ImpactPoint, AActor*
 	if (bBroken) return;
 	bBroken = true;
 	
-	UWorld* World = GetWorld();
-	if (World && TreasureClasses.Num() > 0)
+	USpawnQueueSubsystem* SpawnQueue = GetWorld()->GetSubsystem<USpawnQueueSubsystem>();
+	if (SpawnQueue && TreasureClasses.Num() > 0)
 	{
 		FVector Location = GetActorLocation();
 		Location.Z += 75.f;
 		int32 Selection = FMath::RandRange(0, TreasureClasses.Num() -1);
-		World->SpawnActor<ATreasure>(TreasureClasses[Selection], Location, GetActorRotation());
+		SpawnQueue->QueueSpawn<ATreasure>(TreasureClasses[Selection], FTransform(GetActorRotation(), Location));
 	}
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Characters/AnimUpdateComparison.h"
+#include "Characters/SlashAnimInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "RenderCore.h"
+#include "Slash.h"
+
+namespace SlashAnimUpdateComparison
+{
+	struct FPathTimes
+	{
+		uint64 AnimCycles = 0;
+		uint64 FrameCycles = 0;
+		int32 NumFrames = 0;
+		int32 NumFrameSamples = 0;
+
+		double GetAnimMs() const { return FPlatformTime::ToMilliseconds64(AnimCycles) / FMath::Max(NumFrames, 1); }
+		double GetFrameMs() const { return FPlatformTime::ToMilliseconds64(FrameCycles) / FMath::Max(NumFrameSamples, 1); }
+	};
+
+	static FPathTimes SnapshotPath;
+	static FPathTimes LegacyPath;
+	static FPathTimes* CurrentPath = nullptr;
+	static int32 FramesPerPath = 0;
+	static int32 PreviousParallelAnimUpdate = 1;
+	static bool bPreviousLegacyUpdate = false;
+	static FDelegateHandle EndFrameHandle;
+
+	static IConsoleVariable* FindParallelAnimUpdate()
+	{
+		return IConsoleManager::Get().FindConsoleVariable(TEXT("a.ParallelAnimUpdate"));
+	}
+
+	static void SetPath(bool bLegacy)
+	{
+		IConsoleVariable* LegacyUpdate = IConsoleManager::Get().FindConsoleVariable(TEXT("slash.Anim.LegacyUpdate"));
+		if (LegacyUpdate) LegacyUpdate->Set(bLegacy, ECVF_SetByConsole);
+		if (IConsoleVariable* ParallelAnimUpdate = FindParallelAnimUpdate())
+		{
+			ParallelAnimUpdate->Set(bLegacy ? 0 : 1, ECVF_SetByConsole);
+		}
+	}
+
+	bool IsRunning()
+	{
+		return CurrentPath != nullptr;
+	}
+
+	void AddGameThreadCycles(uint64 Cycles)
+	{
+		if (CurrentPath) CurrentPath->AnimCycles += Cycles;
+	}
+
+	static void OnEndFrame()
+	{
+		if (CurrentPath == nullptr) return;
+
+		// GGameThreadTime is the previous frame's game thread time, so a run's first sample still belongs to the frame before it
+		if (CurrentPath->NumFrames > 0)
+		{
+			CurrentPath->FrameCycles += GGameThreadTime;
+			++CurrentPath->NumFrameSamples;
+		}
+		if (++CurrentPath->NumFrames < FramesPerPath) return;
+
+		if (CurrentPath == &SnapshotPath)
+		{
+			CurrentPath = &LegacyPath;
+			SetPath(true);
+			return;
+		}
+
+		UE_LOG(LogSlash, Log, TEXT("Slash anim update over %d frames, snapshot + parallel update: game thread %.3f ms/frame, anim instances %.4f ms/frame"),
+			FramesPerPath, SnapshotPath.GetFrameMs(), SnapshotPath.GetAnimMs());
+		UE_LOG(LogSlash, Log, TEXT("Slash anim update over %d frames, legacy + a.ParallelAnimUpdate 0: game thread %.3f ms/frame, anim instances %.4f ms/frame"),
+			FramesPerPath, LegacyPath.GetFrameMs(), LegacyPath.GetAnimMs());
+
+		CurrentPath = nullptr;
+		if (IConsoleVariable* LegacyUpdate = IConsoleManager::Get().FindConsoleVariable(TEXT("slash.Anim.LegacyUpdate")))
+		{
+			LegacyUpdate->Set(bPreviousLegacyUpdate, ECVF_SetByConsole);
+		}
+		if (IConsoleVariable* ParallelAnimUpdate = FindParallelAnimUpdate())
+		{
+			ParallelAnimUpdate->Set(PreviousParallelAnimUpdate, ECVF_SetByConsole);
+		}
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		EndFrameHandle.Reset();
+	}
+
+	static void Start(const TArray<FString>& Args)
+	{
+		if (IsRunning()) return;
+
+		FramesPerPath = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 300;
+		SnapshotPath = FPathTimes();
+		LegacyPath = FPathTimes();
+		bPreviousLegacyUpdate = USlashAnimInstance::IsLegacyUpdateEnabled();
+		IConsoleVariable* ParallelAnimUpdate = FindParallelAnimUpdate();
+		PreviousParallelAnimUpdate = ParallelAnimUpdate ? ParallelAnimUpdate->GetInt() : 1;
+		if (ParallelAnimUpdate == nullptr)
+		{
+			UE_LOG(LogSlash, Warning, TEXT("a.ParallelAnimUpdate not found, the legacy run will still update anim graphs on worker threads"));
+		}
+
+		CurrentPath = &SnapshotPath;
+		SetPath(false);
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&OnEndFrame);
+	}
+}
+
+static FAutoConsoleCommand CmdAnimCompareUpdate(
+	TEXT("slash.Anim.CompareUpdate"),
+	TEXT("Runs N frames (default 300) with the anim snapshot path and parallel anim updates, then N frames with slash.Anim.LegacyUpdate and a.ParallelAnimUpdate 0, ")
+	TEXT("and logs the average game thread frame time and the game thread time of the Slash and enemy anim instances for both. Compare with stat anim for the engine's own split."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SlashAnimUpdateComparison::Start));
@@ -7,9 +7,13 @@
 #include "Items/Weapons/Weapon.h"
 #include "Components/AttributeComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "Animation/AnimMontage.h"
+#include "Slash.h"
+#include "Combat/CombatFXSubsystem.h"
 
 // Sets default values
-ABaseCharacter::ABaseCharacter()
+ABaseCharacter::ABaseCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -25,6 +29,13 @@ void ABaseCharacter::Tick(float DeltaTime)
 void ABaseCharacter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// lets weapon queries skip our bodies by team without a per-hit check
+	const FMaskFilter TeamMaskFilter = ICombatTeamInterface::GetTeamMaskFilter(CombatFlags);
+	GetCapsuleComponent()->SetMaskFilterOnBodyInstance(TeamMaskFilter);
+	GetMesh()->SetMaskFilterOnBodyInstance(TeamMaskFilter);
+
+	ResolveMontageSections();
 }
 
 void ABaseCharacter::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
@@ -42,7 +53,7 @@ void ABaseCharacter::GetHit_Implementation(const FVector& ImpactPoint, AActor* H
 void ABaseCharacter::Attack()
 {
 	// check for dead actor
-	if (CombatTarget && CombatTarget->ActorHasTag(FName("Dead")))
+	if (CombatTarget && EnumHasAnyFlags(ICombatTeamInterface::GetCombatFlagsOf(CombatTarget), ECombatFlags::ECF_Dead))
 	{
 		CombatTarget = nullptr;
 	}
@@ -50,7 +61,8 @@ void ABaseCharacter::Attack()
 
 void ABaseCharacter::Die_Implementation()
 {
-	Tags.Add(FName("Dead")); // add dead tag to prevent other actor keep trying to attack
+	CombatFlags |= ECombatFlags::ECF_Dead; // prevent other actors from trying to attack
+	Tags.Add(FName("Dead")); // still tagged for Blueprints
 	PlayDeathMontage();
 }
 
@@ -58,48 +70,25 @@ void ABaseCharacter::DirectionalHitReact(const FVector& ImpactPoint)
 {
 	const FVector Forward = GetActorForwardVector();
 	// Replace "Z" ToHit point so that the angle is on the same Z axis plane.
-	const FVector ImpactLowered(ImpactPoint.X, ImpactPoint.Y, GetActorLocation().Z);  
-	
-	// Get unit vetor for hitpoint using GetSafeNormal which returns unit vector for use in Dot Product calculation
-	const FVector ToHit = (ImpactLowered - GetActorLocation()).GetSafeNormal();
-
-	// Dot Product formula states:
-	// Forward * ToHit = |Forward||To Hit| * cos(Theta)
-	// So if we use Unit Vectors, then magnitude is 1 so |Forward||To Hit| = 1, therefore;
-	// Forward * ToHit = cos(Theta)
-	const double CosTheta = FVector::DotProduct(Forward, ToHit);
-
-	// To isolate Theta we must take the inverse cosine (arc-cosine) of both sides of the equation
-	// Acos(Forward * ToHit) = Acos cos(Theta) = Theta   // ** this returns value in radians
-	double Theta = FMath::Acos(CosTheta);
-
-	// convert from Radians to Degrees
-	Theta = FMath::RadiansToDegrees(Theta);
-
-	// if CrossProduct points down (Z is negative) then Theta should be negative
-	FVector CrossProduct = FVector::CrossProduct(Forward, ToHit);
-	if (CrossProduct.Z <0)
-	{
-		//negate Theta
-		Theta *= -1.f;
-	}
+	const FVector ImpactLowered(ImpactPoint.X, ImpactPoint.Y, GetActorLocation().Z);
+	const FVector ToHit = ImpactLowered - GetActorLocation();
 
-	FName Section("FromBack");
+	// within 45 degrees of forward or back means cos(Theta)^2 >= 0.5, compared without normalizing ToHit
+	const double Dot = FVector::DotProduct(Forward, ToHit);
+	const bool bWithin45 = Dot * Dot >= 0.5 * ToHit.SizeSquared();
 
-	if (Theta >= -45.f && Theta < 45.f)
+	EHitReactDirection Direction;
+	if (bWithin45)
 	{
-		Section = FName("FromFront");
+		Direction = Dot >= 0.0 ? EHitReactDirection::EHRD_Front : EHitReactDirection::EHRD_Back;
 	}
-	else if (Theta >= -135.f && Theta < -45.f)
+	else
 	{
-		Section = FName("FromLeft");
-	}
-	else if (Theta >= 45.f && Theta < 135.f)
-	{
-		Section = FName("FromRight");
+		// if CrossProduct points down (Z is negative) the hit came from the left
+		Direction = FVector::CrossProduct(Forward, ToHit).Z < 0.0 ? EHitReactDirection::EHRD_Left : EHitReactDirection::EHRD_Right;
 	}
 
-	PlayHitReactMontageMontage(Section);
+	PlayHitReactMontageMontage(Direction);
 }
 
 void ABaseCharacter::HandleDamage(float DamageAmount)
@@ -112,7 +101,13 @@ void ABaseCharacter::HandleDamage(float DamageAmount)
 
 void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint)
 {
-	if (HitSound)
+	if (HitSound == nullptr) return;
+
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>())
+	{
+		CombatFX->PlaySound(HitSound, ImpactPoint);
+	}
+	else
 	{
 		UGameplayStatics::PlaySoundAtLocation(this, HitSound, ImpactPoint);
 	}
@@ -120,7 +115,16 @@ void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint)
 
 void ABaseCharacter::SpawnHitParticles(const FVector& ImpactPoint)
 {
-	if (HitParticles && GetWorld())
+	UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>();
+	if (HitEffect && CombatFX)
+	{
+		CombatFX->SpawnEffect(HitEffect, ImpactPoint);
+	}
+	else if (HitParticles && CombatFX)
+	{
+		CombatFX->SpawnLegacyEffect(HitParticles, ImpactPoint);
+	}
+	else if (HitParticles)
 	{
 		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), HitParticles, ImpactPoint);
 	}
@@ -168,34 +172,29 @@ void ABaseCharacter::DisableMeshCollision()
 	GetMesh()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
-void ABaseCharacter::PlayHitReactMontageMontage(const FName SectionName)
+void ABaseCharacter::PlayHitReactMontageMontage(EHitReactDirection Direction)
 {
-	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && HitReactMontage)
-	{
-		AnimInstance->Montage_Play(HitReactMontage);
-		AnimInstance->Montage_JumpToSection(SectionName, HitReactMontage);
-	}
+	PlayResolvedSection(HitReactSections[(int32)Direction]);
 }
 
 void ABaseCharacter::PlayDodgeMontage()
 {
-	PlayMontageSection(DodgeMontage, FName("Dodge1"));
+	PlayResolvedSection(DodgeSection);
 }
 
 int32 ABaseCharacter::PlayAttackMontage()
 {
-	return PlayRandomMontageSection(AttackMontage, AttackMontageSections);
+	return PlayRandomMontageSection(AttackSections);
 }
 
 void ABaseCharacter::PlaySpecificAttackMontage()
 {
-	PlayMontageSection(SpecificAttackMontage, SpecificAttackMontageSection);
+	PlayResolvedSection(SpecificAttackSection);
 }
 
 int32 ABaseCharacter::PlayDeathMontage()
 {
-	const int32 Selection = PlayRandomMontageSection(DeathMontage, DeathMontageSections);
+	const int32 Selection = PlayRandomMontageSection(DeathSections);
 
 	// convert/assign returned int32 value to ENUM value** but chack is valid against ENUM DefaultMAX
 	TEnumAsByte<EDeathPose> Pose(Selection);
@@ -248,30 +247,68 @@ void ABaseCharacter::AttackEnd()
 
 void ABaseCharacter::SetWeaponCollisionEnabled(ECollisionEnabled::Type CollisionEnabled)
 {
-	if (EquippedWeapon && EquippedWeapon->GetWeaponCollisionBox())
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->SetWeaponCollisionEnabled(CollisionEnabled);
+	}
+}
+
+void ABaseCharacter::ResolveMontageSections()
+{
+	// index i of the resolved arrays is always section name i, PlayDeathMontage relies on it for DeathPose
+	AttackSections.Reset(AttackMontageSections.Num());
+	for (const FName& SectionName : AttackMontageSections)
+	{
+		AttackSections.Add(ResolveMontageSection(AttackMontage, SectionName));
+	}
+	DeathSections.Reset(DeathMontageSections.Num());
+	for (const FName& SectionName : DeathMontageSections)
+	{
+		DeathSections.Add(ResolveMontageSection(DeathMontage, SectionName));
+	}
+
+	SpecificAttackSection = ResolveMontageSection(SpecificAttackMontage, SpecificAttackMontageSection);
+	DodgeSection = ResolveMontageSection(DodgeMontage, FName("Dodge1"));
+	HitReactSections[(int32)EHitReactDirection::EHRD_Front] = ResolveMontageSection(HitReactMontage, FName("FromFront"));
+	HitReactSections[(int32)EHitReactDirection::EHRD_Back] = ResolveMontageSection(HitReactMontage, FName("FromBack"));
+	HitReactSections[(int32)EHitReactDirection::EHRD_Left] = ResolveMontageSection(HitReactMontage, FName("FromLeft"));
+	HitReactSections[(int32)EHitReactDirection::EHRD_Right] = ResolveMontageSection(HitReactMontage, FName("FromRight"));
+}
+
+FResolvedMontageSection ABaseCharacter::ResolveMontageSection(UAnimMontage* Montage, const FName& SectionName) const
+{
+	FResolvedMontageSection Resolved;
+	// characters without this montage just never play it
+	if (Montage == nullptr) return Resolved;
+
+	Resolved.SectionIndex = Montage->GetSectionIndex(SectionName);
+	if (Resolved.SectionIndex == INDEX_NONE)
 	{
-		EquippedWeapon->GetWeaponCollisionBox()->SetCollisionEnabled(CollisionEnabled);
-		EquippedWeapon->IgnoreActors.Empty();
+		UE_LOG(LogSlash, Error, TEXT("%s: montage %s has no section %s"), *GetClass()->GetName(), *Montage->GetName(), *SectionName.ToString());
+		return Resolved;
 	}
+
+	Resolved.Montage = Montage;
+	Resolved.StartTime = Montage->GetAnimCompositeSection(Resolved.SectionIndex).GetTime();
+	return Resolved;
 }
 
-void ABaseCharacter::PlayMontageSection(UAnimMontage* Montage, const FName& SectionName)
+void ABaseCharacter::PlayResolvedSection(const FResolvedMontageSection& Section)
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if(AnimInstance && Montage) 
+	if (AnimInstance && Section.IsValid())
 	{
-		AnimInstance->Montage_Play(Montage);
-		AnimInstance->Montage_JumpToSection(SectionName, Montage);
+		AnimInstance->Montage_Play(Section.Montage, 1.f, EMontagePlayReturnType::MontageLength, Section.StartTime);
 	}
 }
 
-int32 ABaseCharacter::PlayRandomMontageSection(UAnimMontage* Montage, const TArray<FName>& SectionNames)
+int32 ABaseCharacter::PlayRandomMontageSection(const TArray<FResolvedMontageSection>& Sections)
 {
-	if (SectionNames.Num() <=0) return -1;
-	const int32 MaxSectionIndex = SectionNames.Num() - 1;
+	if (Sections.Num() <=0) return -1;
+	const int32 MaxSectionIndex = Sections.Num() - 1;
 	const int32 Selection = FMath::RandRange(0, MaxSectionIndex);
 
-	PlayMontageSection(Montage, SectionNames[Selection]);
+	PlayResolvedSection(Sections[Selection]);
 	return Selection;
 }
 
@@ -5,6 +5,22 @@
 #include "Characters/SlashCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "HAL/IConsoleManager.h"
+#include "Characters/AnimUpdateComparison.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Slash Anim Game Thread"), STAT_SlashAnimGameThread, STATGROUP_Slash);
+DECLARE_CYCLE_STAT(TEXT("Slash Anim Worker"), STAT_SlashAnimWorker, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarAnimLegacyUpdate(
+    TEXT("slash.Anim.LegacyUpdate"),
+    false,
+    TEXT("Read the character on the game thread in NativeUpdateAnimation instead of using the pushed snapshot."));
+
+bool USlashAnimInstance::IsLegacyUpdateEnabled()
+{
+    return CVarAnimLegacyUpdate.GetValueOnGameThread();
+}
 
 void USlashAnimInstance::NativeInitializeAnimation()
 {
@@ -19,12 +35,43 @@ void USlashAnimInstance::NativeInitializeAnimation()
     
 }
 
-
-
 void USlashAnimInstance::NativeUpdateAnimation(float DeltaTime)
 {
     Super::NativeUpdateAnimation(DeltaTime);
+    SCOPE_CYCLE_COUNTER(STAT_SlashAnimGameThread);
+    SlashAnimUpdateComparison::FScopedGameThreadTimer ComparisonTimer;
+
+    bLegacyUpdate = IsLegacyUpdateEnabled();
+    if (bLegacyUpdate)
+    {
+        LegacyUpdateFromCharacter();
+        return;
+    }
 
+    Snapshot.Latch();
+}
+
+void USlashAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaTime)
+{
+    Super::NativeThreadSafeUpdateAnimation(DeltaTime);
+    SCOPE_CYCLE_COUNTER(STAT_SlashAnimWorker);
+    // only counted when a.ParallelAnimUpdate 0 runs this on the game thread
+    SlashAnimUpdateComparison::FScopedGameThreadTimer ComparisonTimer;
+
+    if (bLegacyUpdate) return;
+
+    const FSlashAnimSnapshot& Latched = Snapshot.Get();
+    WalkSpeed = Latched.WalkSpeed;
+    RunSpeed = Latched.RunSpeed;
+    GroundSpeed = Latched.GroundSpeed;
+    IsFalling = Latched.bIsFalling;
+    CharacterState = Latched.CharacterState;
+    ActionState = Latched.ActionState;
+    DeathPose = Latched.DeathPose;
+}
+
+void USlashAnimInstance::LegacyUpdateFromCharacter()
+{
     if (SlashCharacterMovement)
     {
         WalkSpeed = SlashCharacter->GetWalkSpeed(); 
@@ -35,4 +82,4 @@ void USlashAnimInstance::NativeUpdateAnimation(float DeltaTime)
         ActionState = SlashCharacter->GetActionState();
         DeathPose = SlashCharacter->GetDeathPose();
     }
-}
\ No newline at end of file
+}
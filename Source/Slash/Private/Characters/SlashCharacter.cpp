@@ -16,8 +16,9 @@
 #include "HUD/HUDOverlay.h"
 #include "Components/AttributeComponent.h"
 #include "Items/Treasure.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "Components/TargetTrackingComponent.h"
 #include "Math/Vector.h"
+#include "AI/EnemyPerceptionSubsystem.h"
 
 
 // Sets default values
@@ -29,6 +30,8 @@ ASlashCharacter::ASlashCharacter()
 	bUseControllerRotationYaw = false;
 	bUseControllerRotationRoll = false;
 
+	CombatFlags = ECombatFlags::ECF_Player | ECombatFlags::ECF_Engageable;
+
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->RotationRate = FRotator(0.f, 400.f, 0.f);
 
@@ -56,22 +59,19 @@ ASlashCharacter::ASlashCharacter()
 	Eyebrows = CreateDefaultSubobject<UGroomComponent>(TEXT("Eyebrows"));
 	Eyebrows->SetupAttachment(GetMesh());
 	Eyebrows->AttachmentName = FString("Head");
+
+	TargetTracking = CreateDefaultSubobject<UTargetTrackingComponent>(TEXT("TargetTracking"));
+	TargetTracking->SetupAttachment(GetRootComponent());
 }
 
 void ASlashCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	
-	if (Attributes && HUDOverlay)
-	{
-		Attributes->RegenStamina(DeltaTime);
-		HUDOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
-	}
-
 
-		SetCombatTargetToClosestEnemyInRange();
+	// picked by the target tracking component at its own rate
+	CombatTarget = TargetTracking->GetTarget();
 
-	
+	PushAnimSnapshot();
 }
 
 void ASlashCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -103,8 +103,7 @@ void ASlashCharacter::Jump()
 float ASlashCharacter::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser)
 {
 	HandleDamage(DamageAmount);
-	CombatTarget = EventInstigator->GetPawn();
-	SetHUDHealth();
+	if (EventInstigator) CombatTarget = EventInstigator->GetPawn();
 	return DamageAmount;
 }
 
@@ -127,27 +126,41 @@ void ASlashCharacter::SetOverlappingItem(AItem* Item)
 
 void ASlashCharacter::AddSouls(ASoul* Soul)
 {
-	if (Attributes && HUDOverlay)
+	// the HUD follows the attribute change events
+	if (Attributes)
 	{
 		Attributes->AddSouls(Soul->GetSouls());
-		HUDOverlay->SetSouls(Attributes->GetSouls());
 	}
 }
 
 void ASlashCharacter::AddGold(ATreasure* Treasure)
 {
-	if (Attributes && HUDOverlay)
+	if (Attributes)
 	{
 		Attributes->AddGold(Treasure->GetGold());
-		HUDOverlay->SetGold(Attributes->GetGold());
 	}
 }
 
+void ASlashCharacter::SetCombatRadius(double NewCombatRadius)
+{
+	CombatRadius = NewCombatRadius;
+	TargetTracking->SetTrackingRadius(CombatRadius);
+}
+
 void ASlashCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	Tags.Add(FName("EngageableCharacter"));
+	Tags.Add(FName("EngageableCharacter")); // combat code reads CombatFlags, the tag is kept for Blueprints
+
+	// lock-on candidates are whatever is inside the combat radius
+	TargetTracking->SetTrackingRadius(CombatRadius);
+
+	// let enemies see us through the shared perception service
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->RegisterTarget(this);
+	}
 
 	if (APlayerController* PlayerController = Cast<APlayerController>(GetController()))
 	{
@@ -213,7 +226,7 @@ void ASlashCharacter::EKeyPressed()
 
 	if (OverlappingWeapon && CharacterState == ECharacterState::ECS_Unequipped)
 	{
-		if (EquippedWeapon) EquippedWeapon->Destroy();
+		if (EquippedWeapon) EquippedWeapon->Despawn();
 
 		EquipWeapon(OverlappingWeapon);
 	}
@@ -263,7 +276,6 @@ void ASlashCharacter::Dodge()
 	ActionState = EActionState::EAS_Dodge;
 	PlayDodgeMontage(); 	
 	Attributes->UseStamina(Attributes->GetDodgeStaminaCost());
-	if (HUDOverlay)	HUDOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
 }
 
 void ASlashCharacter::EquipWeapon(AWeapon* Weapon)
@@ -307,26 +319,29 @@ bool ASlashCharacter::CanArm()
 
 void ASlashCharacter::Disarm()
 {
-	PlayEquipMontage(FName("Unequip"));
+	PlayEquipMontage(UnequipSection);
 	CharacterState = ECharacterState::ECS_Unequipped;
 	ActionState = EActionState::EAS_EquippingWeapon;
 }
 
 void ASlashCharacter::Arm()
 {
-	PlayEquipMontage(FName("Equip"));
+	PlayEquipMontage(EquipSection);
 	CharacterState = ECharacterState::ECS_EquippedOneHandedWeapon;
 	ActionState = EActionState::EAS_EquippingWeapon;
 }
 
-void ASlashCharacter::PlayEquipMontage(const FName SectionName)
+void ASlashCharacter::PlayEquipMontage(const FResolvedMontageSection& Section)
 {
-	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && EquipMontage)
-	{
-		AnimInstance->Montage_Play(EquipMontage);
-		AnimInstance->Montage_JumpToSection(SectionName, EquipMontage);
-	}
+	PlayResolvedSection(Section);
+}
+
+void ASlashCharacter::ResolveMontageSections()
+{
+	Super::ResolveMontageSections();
+
+	EquipSection = ResolveMontageSection(EquipMontage, FName("Equip"));
+	UnequipSection = ResolveMontageSection(EquipMontage, FName("Unequip"));
 }
 
 void ASlashCharacter::Die_Implementation()
@@ -363,69 +378,24 @@ void ASlashCharacter::HitReactEnd()
 	ActionState = EActionState::EAS_Unoccupied;
 }
 
-void ASlashCharacter::SetCombatTargetToClosestEnemyInRange()
+void ASlashCharacter::PushAnimSnapshot()
 {
-	const FVector CharacterPos = GetActorLocation();
-
-	// Set what actors to seek out from it's collision channel
-	TArray<TEnumAsByte<EObjectTypeQuery>> traceObjectTypes;
-	traceObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECollisionChannel::ECC_Pawn));
+	USlashAnimInstance* SlashAnimInstance = Cast<USlashAnimInstance>(GetMesh()->GetAnimInstance());
+	if (SlashAnimInstance == nullptr || USlashAnimInstance::IsLegacyUpdateEnabled()) return;
 
-    TArray<AActor*> ActorsToIgnore;
-    ActorsToIgnore.Add(this);
- //   ActorsToIgnore.Add(GetOwner());
+	FSlashAnimSnapshot Snapshot;
+	Snapshot.WalkSpeed = WalkSpeed;
+	Snapshot.RunSpeed = RunSpeed;
+	Snapshot.GroundSpeed = GetCharacterMovement()->Velocity.Size2D();
+	Snapshot.bIsFalling = GetCharacterMovement()->IsFalling();
+	Snapshot.CharacterState = CharacterState;
+	Snapshot.ActionState = ActionState;
+	Snapshot.DeathPose = DeathPose;
 
-	TArray<AActor*> OutActors;
-
-	// perform sphere Trace with combat radius
-	UKismetSystemLibrary::SphereOverlapActors
-	(
-    	this,
-    	CharacterPos,
-    	CombatRadius,
-    	traceObjectTypes,
-   		NULL,
-    	ActorsToIgnore,
-    	OutActors
-	);
-
-	double ClosestDistance = CombatRadius;
-	AActor* ClosestTarget = nullptr;
-	
-	if (OutActors.Num() != 0)
-	{
-		for (int32 Index = 0; Index != OutActors.Num(); ++Index)
-    	{
-      		double DistanceToTarget = (CharacterPos - OutActors[Index]->GetActorLocation()).Size();
-				
-			if (DistanceToTarget < ClosestDistance && OutActors[Index]->ActorHasTag(FName("Enemy")))
-			{
-				ClosestDistance = DistanceToTarget;
-				ClosestTarget = OutActors[Index];		
-			}
-    	}
-	}
-
-	CombatTarget = ClosestTarget;
-
-	// screen meesage
-	if (CombatTarget != nullptr)
-	{
-		const FString EnemyName = CombatTarget->GetName();
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage (1, 2.f, FColor::Red, EnemyName );
-		}	
-	}
-	else 
-	{
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage (1, 2.f, FColor::Red, TEXT("Null pointer no enemy in range") );
-		}	
-	}
-
-	
+	if (bAnimSnapshotPushed && Snapshot == LastAnimSnapshot) return;
+	SlashAnimInstance->PushSnapshot(Snapshot);
+	LastAnimSnapshot = Snapshot;
+	bAnimSnapshotPushed = true;
 }
 
 bool ASlashCharacter::IsUnoccuppied()
@@ -450,36 +420,10 @@ void ASlashCharacter::InitializeHUDOverlay()
 		if (ASlashHUD* SlashHUD = Cast<ASlashHUD>(PlayerController->GetHUD()))
 		{
 			HUDOverlay = SlashHUD->GetHUDOverlay();
-			if (HUDOverlay && Attributes)
+			if (HUDOverlay)
 			{
-				HUDOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
-				HUDOverlay->SetHealthBarPercent(1.f);
-				HUDOverlay->SetGold(0);
-				HUDOverlay->SetSouls(0);
+				HUDOverlay->BindToAttributes(Attributes);
 			}
 		}
 	}
 }
-
-void ASlashCharacter::SetHUDHealth()
-{
-	if (HUDOverlay && Attributes)
-	{
-		HUDOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
-	}
-}
-
-void ASlashCharacter::SetHUDStamina()
-{
-
-}
-
-void ASlashCharacter::SetHUDGold()
-{
-
-}
-
-void ASlashCharacter::SetHUDSouls()
-{
-
-}
\ No newline at end of file
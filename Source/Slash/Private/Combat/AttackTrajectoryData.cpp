@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/AttackTrajectoryData.h"
+#include "Animation/AnimMontage.h"
+#include "Slash.h"
+
+#if WITH_EDITOR
+#include "Characters/BaseCharacter.h"
+#include "Items/Weapons/Weapon.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "AnimPose.h"
+#endif
+
+const FBakedAttackTrajectory* UAttackTrajectoryData::FindTrajectory(const UAnimMontage* Montage, FName Section) const
+{
+	return Trajectories.FindByPredicate([Montage, Section](const FBakedAttackTrajectory& Trajectory)
+	{
+		return Trajectory.Montage == Montage && Trajectory.Section == Section;
+	});
+}
+
+bool UAttackTrajectoryData::Sample(const FBakedAttackTrajectory& Trajectory, float SectionTime, FVector& OutStart, FVector& OutStop)
+{
+	const int32 NumSamples = Trajectory.StartSamples.Num();
+	if (NumSamples == 0 || Trajectory.StopSamples.Num() != NumSamples || Trajectory.SampleInterval <= 0.f) return false;
+
+	const float SamplePosition = FMath::Clamp(SectionTime / Trajectory.SampleInterval, 0.f, (float)(NumSamples - 1));
+	const int32 Index = FMath::Min(FMath::FloorToInt32(SamplePosition), NumSamples - 1);
+	const int32 NextIndex = FMath::Min(Index + 1, NumSamples - 1);
+	const float Alpha = SamplePosition - Index;
+
+	OutStart = FVector(FMath::Lerp(Trajectory.StartSamples[Index], Trajectory.StartSamples[NextIndex], Alpha));
+	OutStop = FVector(FMath::Lerp(Trajectory.StopSamples[Index], Trajectory.StopSamples[NextIndex], Alpha));
+	return true;
+}
+
+#if WITH_EDITOR
+void UAttackTrajectoryData::Bake()
+{
+	Trajectories.Reset();
+
+	const ABaseCharacter* Character = CharacterClass ? CharacterClass->GetDefaultObject<ABaseCharacter>() : nullptr;
+	const AWeapon* Weapon = WeaponClass ? WeaponClass->GetDefaultObject<AWeapon>() : nullptr;
+	USkeletalMesh* Mesh = Character && Character->GetMesh() ? Character->GetMesh()->GetSkeletalMeshAsset() : nullptr;
+	if (Mesh == nullptr || Weapon == nullptr)
+	{
+		UE_LOG(LogSlash, Error, TEXT("%s: bake needs a CharacterClass with a skeletal mesh and a WeaponClass"), *GetName());
+		return;
+	}
+
+	const USkeletalMeshSocket* Socket = Mesh->FindSocket(WeaponSocketName);
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogSlash, Error, TEXT("%s: %s has no socket %s"), *GetName(), *Mesh->GetName(), *WeaponSocketName.ToString());
+		return;
+	}
+
+	// the weapon root snaps to the socket, so its trace points are fixed offsets from the socket
+	const FVector StartInWeapon = Weapon->GetBoxTraceStart()->GetRelativeLocation();
+	const FVector StopInWeapon = Weapon->GetBoxTraceStop()->GetRelativeLocation();
+	const FTransform MeshToRoot = Character->GetMesh()->GetRelativeTransform();
+	const FTransform SocketToBone = Socket->GetSocketLocalTransform();
+
+	BakeMontage(Character->GetAttackMontage(), MeshToRoot, SocketToBone, Socket->BoneName, StartInWeapon, StopInWeapon);
+	BakeMontage(Character->GetSpecificAttackMontage(), MeshToRoot, SocketToBone, Socket->BoneName, StartInWeapon, StopInWeapon);
+
+	MarkPackageDirty();
+	UE_LOG(LogSlash, Log, TEXT("%s: baked %d attack trajectories"), *GetName(), Trajectories.Num());
+}
+
+void UAttackTrajectoryData::BakeMontage(UAnimMontage* Montage, const FTransform& MeshToRoot, const FTransform& SocketToBone, FName BoneName, const FVector& StartInWeapon, const FVector& StopInWeapon)
+{
+	if (Montage == nullptr || Montage->SlotAnimTracks.Num() == 0) return;
+
+	USkeletalMesh* Mesh = CharacterClass->GetDefaultObject<ABaseCharacter>()->GetMesh()->GetSkeletalMeshAsset();
+	FAnimPoseEvaluationOptions EvaluationOptions;
+	EvaluationOptions.OptionalSkeletalMesh = Mesh;
+
+	const FAnimTrack& AnimTrack = Montage->SlotAnimTracks[0].AnimTrack;
+	const float SampleInterval = 1.f / SampleRate;
+
+	for (int32 SectionIndex = 0; SectionIndex < Montage->CompositeSections.Num(); ++SectionIndex)
+	{
+		FBakedAttackTrajectory& Trajectory = Trajectories.AddDefaulted_GetRef();
+		Trajectory.Montage = Montage;
+		Trajectory.Section = Montage->CompositeSections[SectionIndex].SectionName;
+		Trajectory.SectionStart = Montage->CompositeSections[SectionIndex].GetTime();
+		Trajectory.SampleInterval = SampleInterval;
+
+		const float SectionLength = Montage->GetSectionLength(SectionIndex);
+		const int32 NumSamples = FMath::CeilToInt32(SectionLength * SampleRate) + 1;
+		Trajectory.StartSamples.Reserve(NumSamples);
+		Trajectory.StopSamples.Reserve(NumSamples);
+
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			// montage time -> the sequence playing in the slot at that time -> its pose
+			const float MontageTime = Trajectory.SectionStart + FMath::Min(Sample * SampleInterval, SectionLength);
+			const FAnimSegment* Segment = AnimTrack.GetSegmentAtTime(MontageTime);
+			const UAnimSequenceBase* Sequence = Segment ? Segment->GetAnimReference() : nullptr;
+
+			FTransform BoneTransform = FTransform::Identity;
+			if (Sequence)
+			{
+				FAnimPose Pose;
+				UAnimPoseExtensions::GetAnimPoseAtTime(Sequence, Segment->ConvertTrackPosToAnimPos(MontageTime), EvaluationOptions, Pose);
+				BoneTransform = UAnimPoseExtensions::GetBonePose(Pose, BoneName, EAnimPoseSpaces::World);
+			}
+
+			const FTransform SocketToRoot = SocketToBone * BoneTransform * MeshToRoot;
+			Trajectory.StartSamples.Add(FVector3f(SocketToRoot.TransformPosition(StartInWeapon)));
+			Trajectory.StopSamples.Add(FVector3f(SocketToRoot.TransformPosition(StopInWeapon)));
+		}
+	}
+}
+#endif
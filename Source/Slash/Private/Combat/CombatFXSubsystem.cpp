@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/CombatFXSubsystem.h"
+#include "NiagaraFunctionLibrary.h"
+#include "NiagaraComponent.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Sound/SoundConcurrency.h"
+#include "Kismet/GameplayStatics.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Spawned"), STAT_FXSpawned, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Culled"), STAT_FXCulled, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Over Budget"), STAT_FXOverBudget, STATGROUP_Slash);
+
+static TAutoConsoleVariable<int32> CVarFXMaxEffectsPerFrame(
+	TEXT("slash.FX.MaxEffectsPerFrame"),
+	8,
+	TEXT("Particle effects that may start per frame, the rest are dropped. 0 or less for no limit."));
+
+static TAutoConsoleVariable<int32> CVarFXMaxSoundsPerFrame(
+	TEXT("slash.FX.MaxSoundsPerFrame"),
+	6,
+	TEXT("Sounds that may start per frame, the rest are dropped. 0 or less for no limit."));
+
+static TAutoConsoleVariable<int32> CVarFXMaxConcurrentSounds(
+	TEXT("slash.FX.MaxConcurrentSounds"),
+	16,
+	TEXT("Voices the combat sound concurrency group may play at once before the oldest is stopped. Read when the world starts."));
+
+static TAutoConsoleVariable<float> CVarFXCullDistance(
+	TEXT("slash.FX.CullDistance"),
+	8000.f,
+	TEXT("Effects and sounds further than this from the camera are skipped. 0 or less to never cull."));
+
+void UCombatFXSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SoundConcurrency = NewObject<USoundConcurrency>(this, TEXT("CombatSoundConcurrency"), RF_Transient);
+	SoundConcurrency->Concurrency.MaxCount = FMath::Max(CVarFXMaxConcurrentSounds.GetValueOnGameThread(), 1);
+	SoundConcurrency->Concurrency.ResolutionRule = EMaxConcurrentResolutionRule::StopOldest;
+}
+
+bool UCombatFXSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCombatFXSubsystem::SpawnEffect(UNiagaraSystem* System, const FVector& Location, const FRotator& Rotation)
+{
+	if (System == nullptr) return false;
+
+	BeginFrameIfNeeded();
+	if (!IsWithinCullDistance(Location))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return false;
+	}
+	const int32 MaxEffects = CVarFXMaxEffectsPerFrame.GetValueOnGameThread();
+	if (MaxEffects > 0 && EffectsThisFrame >= MaxEffects)
+	{
+		INC_DWORD_STAT(STAT_FXOverBudget);
+		return false;
+	}
+
+	++EffectsThisFrame;
+	INC_DWORD_STAT(STAT_FXSpawned);
+	UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, System, Location, Rotation, FVector(1.f), true, true, ENCPoolMethod::AutoRelease);
+	return true;
+}
+
+bool UCombatFXSubsystem::SpawnLegacyEffect(UParticleSystem* Particles, const FVector& Location, const FRotator& Rotation)
+{
+	if (Particles == nullptr) return false;
+
+	BeginFrameIfNeeded();
+	if (!IsWithinCullDistance(Location))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return false;
+	}
+	const int32 MaxEffects = CVarFXMaxEffectsPerFrame.GetValueOnGameThread();
+	if (MaxEffects > 0 && EffectsThisFrame >= MaxEffects)
+	{
+		INC_DWORD_STAT(STAT_FXOverBudget);
+		return false;
+	}
+
+	++EffectsThisFrame;
+	INC_DWORD_STAT(STAT_FXSpawned);
+	UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Particles, Location, Rotation, FVector(1.f), true, EPSCPoolMethod::AutoRelease);
+	return true;
+}
+
+bool UCombatFXSubsystem::PlaySound(USoundBase* Sound, const FVector& Location)
+{
+	if (Sound == nullptr) return false;
+
+	BeginFrameIfNeeded();
+	if (!IsWithinCullDistance(Location))
+	{
+		INC_DWORD_STAT(STAT_FXCulled);
+		return false;
+	}
+	const int32 MaxSounds = CVarFXMaxSoundsPerFrame.GetValueOnGameThread();
+	if (MaxSounds > 0 && SoundsThisFrame >= MaxSounds)
+	{
+		INC_DWORD_STAT(STAT_FXOverBudget);
+		return false;
+	}
+
+	++SoundsThisFrame;
+	INC_DWORD_STAT(STAT_FXSpawned);
+	UGameplayStatics::PlaySoundAtLocation(this, Sound, Location, FRotator::ZeroRotator, 1.f, 1.f, 0.f, nullptr, SoundConcurrency);
+	return true;
+}
+
+void UCombatFXSubsystem::BeginFrameIfNeeded()
+{
+	if (BudgetFrame == GFrameCounter) return;
+
+	BudgetFrame = GFrameCounter;
+	EffectsThisFrame = 0;
+	SoundsThisFrame = 0;
+
+	// one camera lookup per frame, not per effect
+	const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	bHasViewLocation = CameraManager != nullptr;
+	ViewLocation = CameraManager ? CameraManager->GetCameraLocation() : FVector::ZeroVector;
+}
+
+bool UCombatFXSubsystem::IsWithinCullDistance(const FVector& Location) const
+{
+	const float CullDistance = CVarFXCullDistance.GetValueOnGameThread();
+	if (CullDistance <= 0.f || !bHasViewLocation) return true;
+
+	return FVector::DistSquared(Location, ViewLocation) <= FMath::Square(CullDistance);
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/DamageResolutionSubsystem.h"
+#include "Items/Weapons/Weapon.h"
+#include "Interfaces/HitInterface.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolution"), STAT_DamageResolution, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hits Resolved"), STAT_HitsResolved, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Victims Resolved"), STAT_VictimsResolved, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarCombatBatchDamage(
+	TEXT("slash.Combat.BatchDamage"),
+	true,
+	TEXT("Queue weapon hits and resolve them once per victim at the end of the frame instead of as each hit happens."));
+
+void UDamageResolutionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingHits.Num() > 0)
+	{
+		ResolveHits();
+	}
+}
+
+TStatId UDamageResolutionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageResolutionSubsystem, STATGROUP_Tickables);
+}
+
+bool UDamageResolutionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDamageResolutionSubsystem::QueueHit(AActor* Victim, AWeapon* Weapon, float Damage, const FVector& ImpactPoint)
+{
+	if (Victim == nullptr || Weapon == nullptr) return;
+
+	FPendingHit Hit;
+	Hit.Victim = Victim;
+	Hit.Weapon = Weapon;
+	Hit.Hitter = Weapon->GetOwner();
+	Hit.InstigatorController = Weapon->GetInstigator() ? Weapon->GetInstigator()->GetController() : nullptr;
+	Hit.Damage = Damage;
+	Hit.ImpactPoint = ImpactPoint;
+
+	if (!CVarCombatBatchDamage.GetValueOnGameThread())
+	{
+		ApplyHitDamage(Hit, Hit.Damage);
+		DispatchHitReaction(Hit);
+		return;
+	}
+	PendingHits.Add(MoveTemp(Hit));
+}
+
+void UDamageResolutionSubsystem::ResolveHits()
+{
+	SCOPE_CYCLE_COUNTER(STAT_DamageResolution);
+
+	// reactions can start new hits, those go into the emptied PendingHits for next frame
+	Swap(PendingHits, ResolvingHits);
+	PendingHits.Reset();
+	ResolvedVictims.Reset();
+	VictimIndices.Reset();
+
+	// merge every hit on the same victim, the first one found decides where the reaction plays
+	for (int32 Index = 0; Index < ResolvingHits.Num(); ++Index)
+	{
+		const FPendingHit& Hit = ResolvingHits[Index];
+		AActor* Victim = Hit.Victim.Get();
+		if (Victim == nullptr) continue;
+
+		const int32* VictimIndex = VictimIndices.Find(Victim);
+		if (VictimIndex == nullptr)
+		{
+			VictimIndex = &VictimIndices.Add(Victim, ResolvedVictims.Num());
+			ResolvedVictims.Add({ Index, 0.f });
+		}
+		ResolvedVictims[*VictimIndex].TotalDamage += Hit.Damage;
+	}
+
+	// all damage first, so every reaction sees its victim's final health for this frame
+	for (const FResolvedVictim& Resolved : ResolvedVictims)
+	{
+		ApplyHitDamage(ResolvingHits[Resolved.FirstHit], Resolved.TotalDamage);
+	}
+	for (const FResolvedVictim& Resolved : ResolvedVictims)
+	{
+		DispatchHitReaction(ResolvingHits[Resolved.FirstHit]);
+	}
+
+	SET_DWORD_STAT(STAT_HitsResolved, ResolvingHits.Num());
+	SET_DWORD_STAT(STAT_VictimsResolved, ResolvedVictims.Num());
+	ResolvingHits.Reset();
+}
+
+void UDamageResolutionSubsystem::ApplyHitDamage(const FPendingHit& Hit, float Damage)
+{
+	AActor* Victim = Hit.Victim.Get();
+	if (Victim == nullptr) return;
+
+	UGameplayStatics::ApplyDamage(Victim, Damage, Hit.InstigatorController.Get(), Hit.Weapon.Get(), UDamageType::StaticClass());
+}
+
+void UDamageResolutionSubsystem::DispatchHitReaction(const FPendingHit& Hit)
+{
+	AActor* Victim = Hit.Victim.Get();
+	if (Victim == nullptr) return;
+
+	if (Victim->Implements<UHitInterface>())
+	{
+		IHitInterface::Execute_GetHit(Victim, Hit.ImpactPoint, Hit.Hitter.Get());
+	}
+	if (AWeapon* Weapon = Hit.Weapon.Get())
+	{
+		Weapon->SpawnImpactFields(Hit.ImpactPoint);
+	}
+}
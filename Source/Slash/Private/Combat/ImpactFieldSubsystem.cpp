@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Combat/ImpactFieldSubsystem.h"
+#include "Breakable/BreakableActor.h"
+#include "Field/FieldSystemActor.h"
+#include "Field/FieldSystemComponent.h"
+#include "Field/FieldSystemObjects.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Fields Emitted"), STAT_FieldsEmitted, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Fields Skipped"), STAT_FieldsSkipped, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarFieldNative(
+	TEXT("slash.Field.Native"),
+	true,
+	TEXT("Apply weapon impact fields natively, only near breakables. When off every hit calls the weapon's Blueprint CreateFields."));
+
+static TAutoConsoleVariable<int32> CVarFieldMaxPerFrame(
+	TEXT("slash.Field.MaxPerFrame"),
+	4,
+	TEXT("Impact fields that may be applied per frame, the rest are skipped. 0 or less for no limit."));
+
+void UImpactFieldSubsystem::Deinitialize()
+{
+	Breakables.Empty();
+	FieldSystemActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UImpactFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UImpactFieldSubsystem::IsNativeFieldsEnabled()
+{
+	return CVarFieldNative.GetValueOnGameThread();
+}
+
+void UImpactFieldSubsystem::RegisterBreakable(ABreakableActor* Breakable)
+{
+	Breakables.AddUnique(Breakable);
+}
+
+void UImpactFieldSubsystem::UnregisterBreakable(ABreakableActor* Breakable)
+{
+	Breakables.RemoveSwap(Breakable);
+}
+
+bool UImpactFieldSubsystem::ApplyImpactField(const FVector& Location)
+{
+	if (BudgetFrame != GFrameCounter)
+	{
+		BudgetFrame = GFrameCounter;
+		FieldsThisFrame = 0;
+	}
+
+	const int32 MaxFields = CVarFieldMaxPerFrame.GetValueOnGameThread();
+	if ((MaxFields > 0 && FieldsThisFrame >= MaxFields) || !HasBreakableInRange(Location) || !EnsureFieldSystem())
+	{
+		INC_DWORD_STAT(STAT_FieldsSkipped);
+		return false;
+	}
+	++FieldsThisFrame;
+	INC_DWORD_STAT(STAT_FieldsEmitted);
+
+	// fracture what's in reach, then push the pieces out from the impact
+	UFieldSystemComponent* FieldSystem = FieldSystemActor->GetFieldSystemComponent();
+	FieldSystem->ApplyStrainField(true, Location, FieldRadius, StrainMagnitude, 1);
+
+	VelocityFalloff->SetRadialFalloff(1.f, 0.f, 1.f, 0.f, FieldRadius, Location, EFieldFalloffType::Field_FallOff_None);
+	VelocityVector->SetRadialVector(VelocityMagnitude, Location);
+	VelocityCulling->SetCullingField(VelocityFalloff, VelocityVector, EFieldCullingOperationType::Field_Culling_Outside);
+	FieldSystem->ApplyPhysicsField(true, EFieldPhysicsType::Field_LinearVelocity, nullptr, VelocityCulling);
+	return true;
+}
+
+bool UImpactFieldSubsystem::HasBreakableInRange(const FVector& Location)
+{
+	for (int32 Index = Breakables.Num() - 1; Index >= 0; --Index)
+	{
+		const ABreakableActor* Breakable = Breakables[Index].Get();
+		if (Breakable == nullptr)
+		{
+			Breakables.RemoveAtSwap(Index);
+			continue;
+		}
+
+		const FBoxSphereBounds& Bounds = Breakable->GetRootComponent()->Bounds;
+		if (FVector::DistSquared(Location, Bounds.Origin) <= FMath::Square(FieldRadius + Bounds.SphereRadius))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UImpactFieldSubsystem::EnsureFieldSystem()
+{
+	if (FieldSystemActor) return true;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	FieldSystemActor = GetWorld()->SpawnActor<AFieldSystemActor>(AFieldSystemActor::StaticClass(), FTransform::Identity, SpawnParams);
+	if (FieldSystemActor == nullptr)
+	{
+		UE_LOG(LogSlash, Warning, TEXT("UImpactFieldSubsystem couldn't spawn its field system actor, impact fields are off"));
+		return false;
+	}
+
+	VelocityFalloff = NewObject<URadialFalloff>(this);
+	VelocityVector = NewObject<URadialVector>(this);
+	VelocityCulling = NewObject<UCullingField>(this);
+	return true;
+}
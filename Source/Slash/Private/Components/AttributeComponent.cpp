@@ -5,12 +5,17 @@
 
 UAttributeComponent::UAttributeComponent()
 {
-	PrimaryComponentTick.bCanEverTick = false;
+	// only ticks to regenerate stamina, and only while it's below max
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 }
 
 void UAttributeComponent::BeginPlay()
 {
 	Super::BeginPlay();	
+
+	// owners can start below max stamina
+	SetComponentTickEnabled(Stamina < MaxStamina && StaminaRegenRate > 0.f);
 }
 
 bool UAttributeComponent::IsAlive()
@@ -20,12 +25,35 @@ bool UAttributeComponent::IsAlive()
 
 void UAttributeComponent::ReceiveDamage(float Damage)
 {
-	Health = FMath::Clamp(Health - Damage, 0.f, MaxHealth);
+	SetHealth(FMath::Clamp(Health - Damage, 0.f, MaxHealth));
+}
+
+void UAttributeComponent::ResetAttributes()
+{
+	// used when a pooled owner is reused
+	SetHealth(MaxHealth);
+	SetStamina(MaxStamina);
 }
 
 void UAttributeComponent::UseStamina(float StaminaCost)
 {
-	Stamina = FMath::Clamp(Stamina - StaminaCost, 0.f, MaxHealth);	
+	SetStamina(FMath::Clamp(Stamina - StaminaCost, 0.f, MaxStamina));
+}
+
+void UAttributeComponent::SetHealth(float NewHealth)
+{
+	if (NewHealth == Health) return;
+	Health = NewHealth;
+	OnHealthChanged.Broadcast(GetHealthPercent());
+}
+
+void UAttributeComponent::SetStamina(float NewStamina)
+{
+	if (NewStamina == Stamina) return;
+	Stamina = NewStamina;
+	OnStaminaChanged.Broadcast(GetStaminaPercent());
+
+	SetComponentTickEnabled(Stamina < MaxStamina && StaminaRegenRate > 0.f);
 }
 
 float UAttributeComponent::GetHealthPercent()
@@ -42,20 +70,25 @@ void UAttributeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-
+	RegenStamina(DeltaTime);
 }
 
 void UAttributeComponent::RegenStamina(float DeltaTime)
 {
-	Stamina = FMath::Clamp(Stamina + StaminaRegenRate * DeltaTime, 0.f, MaxStamina);
+	// reaching max switches the tick back off in SetStamina
+	SetStamina(FMath::Clamp(Stamina + StaminaRegenRate * DeltaTime, 0.f, MaxStamina));
 }
 
 void UAttributeComponent::AddGold(int32 AmountOfGold)
 {
+	if (AmountOfGold == 0) return;
 	Gold += AmountOfGold;
+	OnGoldChanged.Broadcast(Gold);
 }
 
 void UAttributeComponent::AddSouls(int32 NumberOfSouls)
 {
+	if (NumberOfSouls == 0) return;
 	Souls += NumberOfSouls;
+	OnSoulsChanged.Broadcast(Souls);
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Components/TargetTrackingComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Interfaces/CombatTeamInterface.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Target Tracking"), STAT_TargetTracking, STATGROUP_Slash);
+
+UTargetTrackingComponent::UTargetTrackingComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickInterval = ScoreInterval;
+
+	// only pawns matter, and only as overlaps
+	SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
+	SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+	SetGenerateOverlapEvents(true);
+	SetCanEverAffectNavigation(false);
+
+	Candidates.Reserve(16);
+}
+
+void UTargetTrackingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetComponentTickInterval(ScoreInterval);
+	OnComponentBeginOverlap.AddDynamic(this, &UTargetTrackingComponent::OnCandidateBeginOverlap);
+	OnComponentEndOverlap.AddDynamic(this, &UTargetTrackingComponent::OnCandidateEndOverlap);
+
+	// enemies already inside the sphere won't send a begin overlap
+	TArray<AActor*> OverlappingActors;
+	GetOverlappingActors(OverlappingActors);
+	for (AActor* Actor : OverlappingActors)
+	{
+		AddCandidate(Actor);
+	}
+}
+
+void UTargetTrackingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	ScoreCandidates();
+}
+
+void UTargetTrackingComponent::SetTrackingRadius(float Radius)
+{
+	// overlaps are updated right away, so the candidates already match the new radius
+	SetSphereRadius(Radius);
+	RefreshTarget();
+}
+
+void UTargetTrackingComponent::RefreshTarget()
+{
+	CurrentTarget = nullptr;
+	ScoreCandidates();
+}
+
+void UTargetTrackingComponent::OnCandidateBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	AddCandidate(OtherActor);
+}
+
+void UTargetTrackingComponent::OnCandidateEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	// an enemy with several overlapping bodies is still in range until the last one leaves
+	if (OtherActor && !IsOverlappingActor(OtherActor))
+	{
+		Candidates.RemoveSwap(OtherActor);
+	}
+}
+
+void UTargetTrackingComponent::AddCandidate(AActor* Actor)
+{
+	if (Actor == nullptr || Actor == GetOwner()) return;
+	if (!EnumHasAnyFlags(ICombatTeamInterface::GetCombatFlagsOf(Actor), ECombatFlags::ECF_Enemy)) return;
+
+	Candidates.AddUnique(Actor);
+}
+
+void UTargetTrackingComponent::ScoreCandidates()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TargetTracking);
+
+	const FVector Origin = GetComponentLocation();
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	FVector ViewDirection = OwnerPawn ? OwnerPawn->GetControlRotation().Vector() : GetForwardVector();
+	ViewDirection = ViewDirection.GetSafeNormal2D();
+
+	AActor* BestCandidate = nullptr;
+	float BestScore = TNumericLimits<float>::Max();
+	float CurrentScore = TNumericLimits<float>::Max();
+
+	for (int32 Index = Candidates.Num() - 1; Index >= 0; --Index)
+	{
+		AActor* Candidate = Candidates[Index].Get();
+		if (Candidate == nullptr)
+		{
+			Candidates.RemoveAtSwap(Index);
+			continue;
+		}
+		// dead enemies stay overlapping until they're pooled, they just can't be targeted
+		if (EnumHasAnyFlags(ICombatTeamInterface::GetCombatFlagsOf(Candidate), ECombatFlags::ECF_Dead)) continue;
+
+		const float Score = ScoreCandidate(Candidate, Origin, ViewDirection);
+		if (Candidate == CurrentTarget.Get())
+		{
+			CurrentScore = Score;
+		}
+		if (Score < BestScore)
+		{
+			BestScore = Score;
+			BestCandidate = Candidate;
+		}
+	}
+
+	AActor* PreviousTarget = CurrentTarget.Get();
+	const bool bHasCurrentTarget = CurrentScore < TNumericLimits<float>::Max();
+	if (!bHasCurrentTarget || BestScore < CurrentScore - SwitchMargin)
+	{
+		CurrentTarget = BestCandidate;
+	}
+
+	if (bShowDebug && GEngine && CurrentTarget.Get() != PreviousTarget)
+	{
+		GEngine->AddOnScreenDebugMessage(1, 2.f, FColor::Red, CurrentTarget.IsValid() ? CurrentTarget->GetName() : TEXT("No enemy in range"));
+	}
+}
+
+float UTargetTrackingComponent::ScoreCandidate(const AActor* Candidate, const FVector& Origin, const FVector& ViewDirection) const
+{
+	// 0 on top of us to 1 at the edge of the sphere, lower is better
+	const FVector ToCandidate = Candidate->GetActorLocation() - Origin;
+	const float RadiusSquared = FMath::Max(FMath::Square(GetScaledSphereRadius()), 1.f);
+	const float DistanceScore = ToCandidate.SizeSquared() / RadiusSquared;
+
+	const float Facing = FVector::DotProduct(ToCandidate.GetSafeNormal2D(), ViewDirection);
+	return DistanceScore - FacingWeight * Facing;
+}
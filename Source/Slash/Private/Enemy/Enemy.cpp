@@ -5,54 +5,65 @@
 #include "AIController.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "Perception/PawnSensingComponent.h"
 #include "Components/AttributeComponent.h"
 #include "HUD/HealthBarComponent.h"
 #include "Items/Weapons/Weapon.h"
 #include "Items/Soul.h"
-
-AEnemy::AEnemy()
-{
-	PrimaryActorTick.bCanEverTick = true;
+#include "AI/EnemyAISubsystem.h"
+#include "AI/EnemyPerceptionSubsystem.h"
+#include "AI/PatrolRouteSubsystem.h"
+#include "AI/CombatCoordinatorSubsystem.h"
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Enemy/EnemyPoseSharingSubsystem.h"
+#include "Items/ActorPoolSubsystem.h"
+#include "Items/SpawnQueueSubsystem.h"
+#include "Combat/AttackTrajectoryData.h"
+#include "Components/CapsuleComponent.h"
+#include "Animation/AnimInstance.h"
+#include "NavigationData.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Slash.h"
+
+// the mesh is budgeted so the animation budget allocator can throttle enemies the player isn't fighting
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
+{
+	// decisions are made in batch by UEnemyAISubsystem, so enemies don't need to tick
+	PrimaryActorTick.bCanEverTick = false;
+	// enemies spawned by UEnemyPoolSubsystem need a controller too
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+	CombatFlags = ECombatFlags::ECF_Enemy;
 
 	GetMesh()->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
 	GetMesh()->SetGenerateOverlapEvents(true);
+	// URO by screen size when the budget allocator is off, the allocator takes the tick rate over when it's on
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+	// significance is set by UEnemyAISubsystem so attacking enemies are never skipped
+	if (USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh()))
+	{
+		BudgetedMesh->SetAutoCalculateSignificance(false);
+	}
 
 	HealthBarWidget = CreateDefaultSubobject<UHealthBarComponent>(TEXT("HealthBar"));
 	HealthBarWidget->SetupAttachment(GetRootComponent());
 
 	GetCharacterMovement()->bOrientRotationToMovement = true;
+	// local avoidance so crowds chasing the same target steer around each other instead of shoving capsules
+	GetCharacterMovement()->bUseRVOAvoidance = true;
+	GetCharacterMovement()->AvoidanceConsiderationRadius = 300.f;
 	bUseControllerRotationPitch = false;
 	bUseControllerRotationYaw = false;
 	bUseControllerRotationRoll = false;
-
-	PawnSensing = CreateDefaultSubobject<UPawnSensingComponent>(TEXT("PawnSensing"));
-	PawnSensing->SetPeripheralVisionAngle(45.f);
-	PawnSensing->SightRadius = 4000.f;
-}
-
-void AEnemy::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-	
-	if (IsDead()) return;
-
-	if (EnemyState > EEnemyState::EES_Patrolling)
-	{
-		CheckCombatTarget();
-	}
-	else
-	{
-		CheckPatrolTarget();
-	}
 }
 
 float AEnemy::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser)
 {
 	HandleDamage(DamageAmount);
-	CombatTarget = EventInstigator->GetPawn();
+	// hits resolved at the end of the frame can outlive the attacker's controller
+	if (EventInstigator) CombatTarget = EventInstigator->GetPawn();
 
 	if (IsInsideAttackRadius())
 	{
@@ -70,22 +81,58 @@ void AEnemy::Destroyed()
 {
 	if (EquippedWeapon)
 	{
-		EquippedWeapon->Destroy();
+		if (UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+		{
+			ActorPool->Release(EquippedWeapon);
+		}
+		else
+		{
+			EquippedWeapon->Destroy();
+		}
 	}
 }
 
 void AEnemy::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
 {
+	// hit react and death montages need our own animation
+	StopSharingPose();
 	Super::GetHit_Implementation(ImpactPoint, Hitter);
 	if (!IsDead()) ShowHealthBar();
 	ClearPatrolTimer();
 	ClearAttackTimer();
 	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
 	StopAttackMontage();
+	// the interrupted attack won't reach AttackEnd, so hand its token back here
+	ReleaseAttackToken();
 
 	if (IsInsideAttackRadius())
 	{
-		if(!IsDead()) StartAttackTimer();
+		if(!IsDead()) RequestAttack();
+	}
+}
+
+void AEnemy::ApplyAICommand(EEnemyAICommand Command)
+{
+	switch (Command)
+	{
+	case EEnemyAICommand::EEAC_LoseInterest:
+		ClearAttackTimer();
+		if (!IsEngaged()) ReleaseAttackToken();
+		LoseInterest();
+		if (!IsEngaged()) StartPatrolloing();
+		break;
+	case EEnemyAICommand::EEAC_ChaseTarget:
+		ClearAttackTimer();
+		if (!IsEngaged()) ChaseTarget();
+		break;
+	case EEnemyAICommand::EEAC_StartAttackTimer:
+		RequestAttack();
+		break;
+	case EEnemyAICommand::EEAC_PatrolTargetReached:
+		PatrolTargetReached();
+		break;
+	default:
+		break;
 	}
 }
 
@@ -93,38 +140,198 @@ void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();	
 
-	Tags.Add(FName("Enemy"));
-	
-	if (PawnSensing) PawnSensing->OnSeePawn.AddDynamic(this, &AEnemy::PawnSeen);
+	Tags.Add(FName("Enemy")); // combat code reads CombatFlags, the tag is kept for Blueprints
 
 	InitializeEnemy();
+	RegisterWithSubsystems();
+
+	// with baked attacks the weapon no longer needs a posed skeleton, so off screen only montages have to advance
+	// the legacy overlap box only moves with the skeleton though, so those weapons keep the mesh fully ticking
+	if (AttackTrajectories)
+	{
+		if (EquippedWeapon && !EquippedWeapon->UsesSweptHitDetection())
+		{
+			UE_LOG(LogSlash, Warning, TEXT("%s has AttackTrajectories but its weapon %s doesn't use swept hit detection, off screen attacks need the posed skeleton"),
+				*GetName(), *EquippedWeapon->GetName());
+		}
+		else
+		{
+			GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		}
+	}
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromSubsystems();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AEnemy::Die_Implementation()
 {
+	StopSharingPose();
 	Super::Die_Implementation();
 	
 	EnemyState = EEnemyState::EES_Dead;
 	ClearAttackTimer();
+	ReleaseAttackToken();
 	HideHealthBar();
 	DisableCapsule();	
-	SetLifeSpan(DeathLifeSpan);
+	GetWorldTimerManager().SetTimer(DeathTimer, this, &AEnemy::DeathTimerFinished, DeathLifeSpan);
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
 	SpawnSoul();
 }
 
+bool AEnemy::GetBakedWeaponTrace(FVector& OutStart, FVector& OutStop) const
+{
+	if (AttackTrajectories == nullptr || !ShouldUseBakedTrajectory()) return false;
+
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	UAnimMontage* Montage = AnimInstance ? AnimInstance->GetCurrentActiveMontage() : nullptr;
+	if (Montage == nullptr) return false;
+
+	const FBakedAttackTrajectory* Trajectory = AttackTrajectories->FindTrajectory(Montage, AnimInstance->Montage_GetCurrentSection(Montage));
+	if (Trajectory == nullptr) return false;
+
+	const float SectionTime = AnimInstance->Montage_GetPosition(Montage) - Trajectory->SectionStart;
+	if (!UAttackTrajectoryData::Sample(*Trajectory, SectionTime, OutStart, OutStop)) return false;
+
+	const FTransform& ActorTransform = GetActorTransform();
+	OutStart = ActorTransform.TransformPosition(OutStart);
+	OutStop = ActorTransform.TransformPosition(OutStop);
+	return true;
+}
+
+bool AEnemy::ShouldUseBakedTrajectory() const
+{
+	// the weapon sockets are stale whenever the skeleton isn't evaluated every frame
+	const USkeletalMeshComponent* EnemyMesh = GetMesh();
+	if (EnemyMesh->bEnableUpdateRateOptimizations && EnemyMesh->AnimUpdateRateParams && EnemyMesh->AnimUpdateRateParams->UpdateRate > 1)
+	{
+		return true;
+	}
+	return !WasRecentlyRendered(0.1f);
+}
+
+void AEnemy::DeathTimerFinished()
+{
+	if (UEnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>())
+	{
+		EnemyPool->ReleaseEnemy(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void AEnemy::DeactivateForPool()
+{
+	UnregisterFromSubsystems();
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	if (EnemyAIController)
+	{
+		EnemyAIController->StopMovement();
+		EnemyAIController->UnPossess();
+	}
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+	GetMesh()->SetComponentTickEnabled(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	HideHealthBar();
+
+	// the weapon stays attached, so the next spawn doesn't need a new one
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->SetActorHiddenInGame(true);
+		SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+}
+
+void AEnemy::ActivateFromPool(const FTransform& Transform, AActor* InPatrolTarget, const TArray<AActor*>& InPatrolTargets)
+{
+	SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// back to the state a freshly spawned enemy starts in
+	EnumRemoveFlags(CombatFlags, ECombatFlags::ECF_Dead);
+	Tags.Remove(FName("Dead"));
+	if (Attributes)
+	{
+		Attributes->ResetAttributes();
+	}
+	if (HealthBarWidget && Attributes)
+	{
+		HealthBarWidget->SetHealthPercent(Attributes->GetHealthPercent());
+	}
+	HideHealthBar();
+	CombatTarget = nullptr;
+	EnemyState = EEnemyState::EES_Patrolling;
+	DeathPose = GetClass()->GetDefaultObject<AEnemy>()->GetDeathPose();
+	bChasingByPathfinding = false;
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	GetMesh()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	GetCharacterMovement()->bOrientRotationToMovement = true;
+	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->SetActorHiddenInGame(false);
+	}
+
+	if (EnemyAIController)
+	{
+		EnemyAIController->Possess(this);
+	}
+	else
+	{
+		SpawnDefaultController();
+		EnemyAIController = Cast<AAIController>(GetController());
+	}
+
+	RegisterWithSubsystems();
+	SetPatrolTargets(InPatrolTarget, InPatrolTargets);
+}
+
+void AEnemy::SetPatrolTargets(AActor* InPatrolTarget, const TArray<AActor*>& InPatrolTargets)
+{
+	PatrolTarget = InPatrolTarget;
+	PatrolTargets = InPatrolTargets;
+	PreviousPatrolTarget = nullptr;
+	// spawned after world begin play, so our patrol points may not have cached routes yet
+	if (UPatrolRouteSubsystem* PatrolRoutes = GetWorld()->GetSubsystem<UPatrolRouteSubsystem>())
+	{
+		PatrolRoutes->AddRoutes(PatrolTargets);
+	}
+	MoveToTarget(PatrolTarget);
+}
+
 void AEnemy::SpawnSoul()
 {
-	UWorld* World = GetWorld();
-	if (World && SoulClass && Attributes)
+	USpawnQueueSubsystem* SpawnQueue = GetWorld()->GetSubsystem<USpawnQueueSubsystem>();
+	if (SpawnQueue && SoulClass && Attributes)
 	{
 		const FVector SpawnLocation = GetActorLocation() + FVector(0.f, 0.f, 125.f);
-		ASoul* SpawnedSoul = World->SpawnActor<ASoul>(SoulClass, SpawnLocation, GetActorRotation());
-		if (SpawnedSoul)
+		// the soul may spawn a few frames later, by which time we could be back in the enemy pool
+		const int32 Souls = Attributes->GetSouls();
+		SpawnQueue->QueueSpawn<ASoul>(SoulClass, FTransform(GetActorRotation(), SpawnLocation), [Souls](ASoul* SpawnedSoul)
 		{
-			SpawnedSoul->SetSouls(Attributes->GetSouls());
-		}	
+			SpawnedSoul->SetSouls(Souls);
+		});
 	}
 }
 
@@ -134,6 +341,7 @@ void AEnemy::Attack()
 
 	if (CombatTarget == nullptr) return; // don't attack dead player
 	EnemyState = EEnemyState::EES_Engaged;
+	StopSharingPose();
 	PlayAttackMontage();
 }
 
@@ -150,6 +358,7 @@ bool AEnemy::CanAttack()
 void AEnemy::AttackEnd()
 {
 	EnemyState = EEnemyState::EES_NoState;
+	ReleaseAttackToken();
 	CheckCombatTarget();
 }
 
@@ -171,39 +380,75 @@ void AEnemy::InitializeEnemy()
 	HideHealthBar();
 }
 
-void AEnemy::CheckCombatTarget()
+void AEnemy::RegisterWithSubsystems()
 {
-	if (IsOutsideCombatRadius())
+	if (UEnemyAISubsystem* EnemyAI = GetWorld()->GetSubsystem<UEnemyAISubsystem>())
 	{
-		ClearAttackTimer();
-		LoseInterest();
-		if (!IsEngaged()) StartPatrolloing();	
-	}	
-	else if (IsOutsideAttackRadius() && !IsChasing())
+		EnemyAI->RegisterEnemy(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
 	{
-		ClearAttackTimer();
-		if (!IsEngaged()) ChaseTarget();
+		Perception->RegisterObserver(this);
 	}
-	else if (CanAttack())
+	if (UEnemyPoseSharingSubsystem* PoseSharing = GetWorld()->GetSubsystem<UEnemyPoseSharingSubsystem>())
 	{
-		StartAttackTimer();
+		PoseSharing->RegisterEnemy(this);
 	}
 }
 
-void AEnemy::CheckPatrolTarget()
+void AEnemy::UnregisterFromSubsystems()
 {
-	
-	if(InTargetRange(PatrolTarget, PatrolRadius))
+	if (UEnemyAISubsystem* EnemyAI = GetWorld()->GetSubsystem<UEnemyAISubsystem>())
+	{
+		EnemyAI->UnregisterEnemy(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterObserver(this);
+	}
+	if (UEnemyPoseSharingSubsystem* PoseSharing = GetWorld()->GetSubsystem<UEnemyPoseSharingSubsystem>())
+	{
+		PoseSharing->UnregisterEnemy(this);
+	}
+	ReleaseAttackToken();
+}
+
+void AEnemy::StopSharingPose()
+{
+	if (UEnemyPoseSharingSubsystem* PoseSharing = GetWorld()->GetSubsystem<UEnemyPoseSharingSubsystem>())
 	{
-		const float WaitTime = FMath::RandRange(PatrolWaitMin, PatrolWaitMax);
-		PatrolTarget = ChoosePatrolTarget();
-		GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::PatrolTimerFinished, WaitTime);
+		PoseSharing->Promote(this);
 	}
 }
 
+void AEnemy::CheckCombatTarget()
+{
+	// same decision the batched pass in UEnemyAISubsystem makes, for event driven callers like AttackEnd
+	const double DistanceSquared = CombatTarget ? FVector::DistSquared(CombatTarget->GetActorLocation(), GetActorLocation()) : 0.0;
+	const EEnemyAICommand Command = UEnemyAISubsystem::EvaluateCombat(
+		EnemyState,
+		CombatTarget != nullptr,
+		DistanceSquared,
+		FMath::Square(CombatRadius),
+		FMath::Square(AttackRadius));
+
+	ApplyAICommand(Command);
+}
+
+void AEnemy::PatrolTargetReached()
+{
+	const float WaitTime = FMath::RandRange(PatrolWaitMin, PatrolWaitMax);
+	PreviousPatrolTarget = PatrolTarget;
+	PatrolTarget = ChoosePatrolTarget();
+	GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::PatrolTimerFinished, WaitTime);
+}
+
 void AEnemy::PatrolTimerFinished()
 {
-	MoveToTarget(PatrolTarget);
+	if (!MoveAlongPatrolRoute(PreviousPatrolTarget, PatrolTarget))
+	{
+		MoveToTarget(PatrolTarget);
+	}
 }
 
 void AEnemy::HideHealthBar()
@@ -226,10 +471,17 @@ void AEnemy::LoseInterest()
 {
 	CombatTarget = nullptr;	
 	HideHealthBar();
+	// a pawn still in view has to be reported again, like repeated OnSeePawn did
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->ForgetSeenPawns(this);
+	}
 }
 
 void AEnemy::StartPatrolloing()
 {
+	// coming back from combat we are not standing at a patrol point, so no cached route applies
+	PreviousPatrolTarget = nullptr;
 	EnemyState = EEnemyState::EES_Patrolling;
 	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
 	MoveToTarget(PatrolTarget);
@@ -237,8 +489,38 @@ void AEnemy::StartPatrolloing()
 
 void AEnemy::ChaseTarget()
 {
+	StopSharingPose();
+	ReleaseAttackToken();
 	EnemyState = EEnemyState::EES_Chasing;
 	GetCharacterMovement()->MaxWalkSpeed = ChasingSpeed;
+
+	if (UEnemyAISubsystem::IsFlowFieldChaseEnabled())
+	{
+		// UEnemyAISubsystem steers us along the shared flow field from now on
+		if (EnemyAIController) EnemyAIController->StopMovement();
+		bChasingByPathfinding = false;
+	}
+	else
+	{
+		bChasingByPathfinding = true;
+		MoveToTarget(CombatTarget);
+	}
+}
+
+void AEnemy::SteerChase(const FVector& Direction)
+{
+	if (bChasingByPathfinding)
+	{
+		if (EnemyAIController) EnemyAIController->StopMovement();
+		bChasingByPathfinding = false;
+	}
+	AddMovementInput(Direction);
+}
+
+void AEnemy::ChaseByPathfinding()
+{
+	if (bChasingByPathfinding) return;
+	bChasingByPathfinding = true;
 	MoveToTarget(CombatTarget);
 }
 
@@ -277,11 +559,48 @@ bool AEnemy::IsEngaged()
 	return EnemyState == EEnemyState::EES_Engaged;
 }
 
+bool AEnemy::IsCircling()
+{
+	return EnemyState == EEnemyState::EES_Circling;
+}
+
 void AEnemy::ClearPatrolTimer()
 {
 	GetWorldTimerManager().ClearTimer(PatrolTimer);
 }
 
+void AEnemy::RequestAttack()
+{
+	// only a limited number of enemies may attack the same target, the rest circle until a token frees up
+	UCombatCoordinatorSubsystem* Coordinator = GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>();
+	if (Coordinator == nullptr || Coordinator->RequestAttackToken(this, CombatTarget))
+	{
+		StartAttackTimer();
+	}
+	else
+	{
+		StartCircling();
+	}
+}
+
+void AEnemy::StartCircling()
+{
+	if (IsCircling()) return;
+
+	// hold position, no montage and no weapon box until we get a token
+	EnemyState = EEnemyState::EES_Circling;
+	if (EnemyAIController) EnemyAIController->StopMovement();
+	bChasingByPathfinding = false;
+}
+
+void AEnemy::ReleaseAttackToken()
+{
+	if (UCombatCoordinatorSubsystem* Coordinator = GetWorld()->GetSubsystem<UCombatCoordinatorSubsystem>())
+	{
+		Coordinator->ReleaseAttackToken(this);
+	}
+}
+
 void AEnemy::StartAttackTimer()
 {
 	EnemyState = EEnemyState::EES_Attacking;
@@ -311,22 +630,43 @@ void AEnemy::MoveToTarget(AActor* Target)
 	EnemyAIController->MoveTo(MoveRequest);
 }
 
+bool AEnemy::MoveAlongPatrolRoute(AActor* From, AActor* To)
+{
+	if (EnemyAIController == nullptr || From == nullptr || To == nullptr) return false;
+
+	UPatrolRouteSubsystem* PatrolRoutes = GetWorld()->GetSubsystem<UPatrolRouteSubsystem>();
+	if (PatrolRoutes == nullptr || !PatrolRoutes->GetRoutePoints(From, To, PatrolRoutePoints)) return false;
+
+	// we stopped somewhere within PatrolRadius of the start point, so walk back onto the route from here
+	PatrolRoutePoints.Insert(GetActorLocation(), 0);
+
+	FAIMoveRequest MoveRequest;
+	MoveRequest.SetGoalLocation(PatrolRoutePoints.Last());
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	FNavPathSharedPtr Path = MakeShared<FNavigationPath, ESPMode::ThreadSafe>(PatrolRoutePoints, nullptr);
+	if (!EnemyAIController->RequestMove(MoveRequest, Path).IsValid()) return false;
+
+	PatrolRoutes->NotifyRouteFollowed();
+	return true;
+}
+
 AActor* AEnemy::ChoosePatrolTarget()
 {
-	TArray<AActor*> ValidTargets;
+	// pick a random patrol target other than the current one, without building a temporary array
+	int32 NumValidTargets = 0;
 	for (AActor* Target : PatrolTargets)
 	{
-		if (Target != PatrolTarget)
-		{
-			ValidTargets.AddUnique(Target);
-		}
+		if (Target != PatrolTarget) ++NumValidTargets;
 	}
+	if (NumValidTargets == 0) return nullptr;
 
-	// generate random selection from patrol target array
-	if(ValidTargets.Num() > 0)
+	int32 Selection = FMath::RandRange(0, NumValidTargets - 1);
+	for (AActor* Target : PatrolTargets)
 	{
-		const int32 Selection = FMath::RandRange(0, ValidTargets.Num()-1);
-		return ValidTargets[Selection];
+		if (Target != PatrolTarget && Selection-- == 0)
+		{
+			return Target;
+		}
 	}
 
 	return nullptr;
@@ -334,10 +674,11 @@ AActor* AEnemy::ChoosePatrolTarget()
 
 void AEnemy::SpawnDefaultWeapon()
 {
-	UWorld* World = GetWorld();
-	if (World && WeaponClass)
+	UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	if (ActorPool && WeaponClass)
 	{
-		AWeapon* DefaultWeapon = World->SpawnActor<AWeapon>(WeaponClass);
+		AWeapon* DefaultWeapon = ActorPool->Acquire<AWeapon>(WeaponClass, GetActorTransform());
+		if (DefaultWeapon == nullptr) return;
 		DefaultWeapon->Equip(GetMesh(), FName("WeaponSocket"), this, this);
 		EquippedWeapon = DefaultWeapon;
 	}
@@ -345,13 +686,11 @@ void AEnemy::SpawnDefaultWeapon()
 
 void AEnemy::PawnSeen(APawn* SeenPawn)
 {
-	if (SeenPawn->ActorHasTag(FName("Dead"))) return;
-
 	const bool bShouldChaseTarget = 
 		EnemyState != EEnemyState::EES_Dead &&
 		EnemyState != EEnemyState::EES_Chasing &&
 		EnemyState < EEnemyState::EES_Attacking &&
-		SeenPawn->ActorHasTag(FName("EngageableCharacter"));
+		ICombatTeamInterface::IsEngageable(SeenPawn);
 	
 	if (bShouldChaseTarget)
 	{
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyAnimInstance.h"
+#include "Characters/AnimUpdateComparison.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Anim Worker"), STAT_EnemyAnimWorker, STATGROUP_Slash);
+
+void UEnemyAnimInstance::NativeUpdateAnimation(float DeltaTime)
+{
+	Super::NativeUpdateAnimation(DeltaTime);
+	SlashAnimUpdateComparison::FScopedGameThreadTimer ComparisonTimer;
+
+	Snapshot.Latch();
+}
+
+void UEnemyAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaTime)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAnimWorker);
+	SlashAnimUpdateComparison::FScopedGameThreadTimer ComparisonTimer;
+
+	const FEnemyAnimSnapshot& Latched = Snapshot.Get();
+	// nothing pushed yet
+	if (Latched.EnemyState == EEnemyState::EES_NoState) return;
+
+	EnemyState = Latched.EnemyState;
+	GroundSpeed = Latched.GroundSpeed;
+	bLocomotionOnly = Latched.bLocomotionOnly;
+	// a patrolling enemy isn't dead, the death pose can wait
+	if (bLocomotionOnly) return;
+
+	DeathPose = Latched.DeathPose;
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyPoolSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Pooled"), STAT_EnemiesPooled, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Reused"), STAT_EnemiesReused, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Spawned"), STAT_EnemiesSpawned, STATGROUP_Slash);
+
+static TAutoConsoleVariable<int32> CVarEnemyPoolMaxPerClass(
+	TEXT("slash.EnemyPool.MaxPerClass"),
+	16,
+	TEXT("Inactive enemies kept per class, dead enemies released beyond this are destroyed."));
+
+bool UEnemyPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AEnemy* UEnemyPoolSubsystem::SpawnEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform, AActor* PatrolTarget, const TArray<AActor*>& PatrolTargets)
+{
+	if (EnemyClass == nullptr) return nullptr;
+
+	AEnemy* Enemy = nullptr;
+	if (FEnemyPool* Pool = Pools.Find(EnemyClass))
+	{
+		while (Pool->Inactive.Num() > 0 && Enemy == nullptr)
+		{
+			Enemy = Pool->Inactive.Pop(false);
+			if (!IsValid(Enemy)) Enemy = nullptr;
+		}
+	}
+
+	if (Enemy)
+	{
+		++NumReused;
+		INC_DWORD_STAT(STAT_EnemiesReused);
+		DEC_DWORD_STAT(STAT_EnemiesPooled);
+		Enemy->ActivateFromPool(Transform, PatrolTarget, PatrolTargets);
+		return Enemy;
+	}
+
+	Enemy = SpawnNewEnemy(EnemyClass, Transform);
+	if (Enemy)
+	{
+		Enemy->SetPatrolTargets(PatrolTarget, PatrolTargets);
+	}
+	return Enemy;
+}
+
+void UEnemyPoolSubsystem::ReleaseEnemy(AEnemy* Enemy)
+{
+	if (!IsValid(Enemy)) return;
+
+	FEnemyPool& Pool = Pools.FindOrAdd(Enemy->GetClass());
+	if (Pool.Inactive.Contains(Enemy)) return;
+
+	// the baseline destroyed every corpse, only keep as many as a wave is likely to need again
+	if (Pool.Inactive.Num() >= CVarEnemyPoolMaxPerClass.GetValueOnGameThread())
+	{
+		Enemy->Destroy();
+		return;
+	}
+
+	Enemy->DeactivateForPool();
+	Pool.Inactive.Add(Enemy);
+	INC_DWORD_STAT(STAT_EnemiesPooled);
+}
+
+void UEnemyPoolSubsystem::Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count)
+{
+	if (EnemyClass == nullptr) return;
+
+	// spawn far below the level so prewarmed enemies never show up for a frame
+	const FTransform HiddenTransform(FVector(0.f, 0.f, -100000.f));
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (AEnemy* Enemy = SpawnNewEnemy(EnemyClass, HiddenTransform))
+		{
+			ReleaseEnemy(Enemy);
+		}
+	}
+	UE_LOG(LogSlash, Log, TEXT("Enemy pool: prewarmed %d %s"), Count, *EnemyClass->GetName());
+}
+
+int32 UEnemyPoolSubsystem::GetNumPooled(TSubclassOf<AEnemy> EnemyClass) const
+{
+	const FEnemyPool* Pool = Pools.Find(EnemyClass);
+	return Pool ? Pool->Inactive.Num() : 0;
+}
+
+AEnemy* UEnemyPoolSubsystem::SpawnNewEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AEnemy* Enemy = World->SpawnActor<AEnemy>(EnemyClass, Transform, SpawnParams);
+	if (Enemy)
+	{
+		INC_DWORD_STAT(STAT_EnemiesSpawned);
+	}
+	return Enemy;
+}
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyPoseSharingSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Animation/AnimSequenceBase.h"
+#include "Animation/AnimInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Pose Sharing"), STAT_EnemyPoseSharing, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Sharing Poses"), STAT_EnemiesSharingPoses, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pose Sharing Leaders"), STAT_PoseSharingLeaders, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarPoseSharing(
+	TEXT("slash.Anim.PoseSharing"),
+	true,
+	TEXT("Patrolling enemies copy their pose from shared leader meshes instead of evaluating their own animation."));
+
+static TAutoConsoleVariable<int32> CVarPoseSharingVariants(
+	TEXT("slash.Anim.PoseSharingVariants"),
+	3,
+	TEXT("Leaders per shared animation, each offset along the cycle. Read when a shared animation is first used."));
+
+// below this ground speed a patrolling enemy is standing at a patrol point
+static constexpr float PoseSharingWalkSpeed = 10.f;
+
+void UEnemyPoseSharingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPoseSharing);
+
+	const bool bEnabled = CVarPoseSharing.GetValueOnGameThread();
+	int32 NumSharing = 0;
+	for (int32 Index = Followers.Num() - 1; Index >= 0; --Index)
+	{
+		FPoseSharingFollower& Follower = Followers[Index];
+		AEnemy* Enemy = Follower.Enemy.Get();
+		if (Enemy == nullptr)
+		{
+			Unfollow(Follower);
+			Followers.RemoveAtSwap(Index);
+			continue;
+		}
+
+		UAnimSequenceBase* Animation = bEnabled ? ChooseSharedAnimation(Enemy) : nullptr;
+		if (Animation == nullptr)
+		{
+			Unfollow(Follower);
+			continue;
+		}
+
+		USkeletalMesh* Mesh = Enemy->GetMesh()->GetSkeletalMeshAsset();
+		if (!Follower.Leader.IsValid() || Follower.Key != FSharedPoseKey(Mesh, Animation))
+		{
+			Unfollow(Follower);
+			Follow(Follower, Mesh, Animation);
+		}
+		++NumSharing;
+	}
+
+	SET_DWORD_STAT(STAT_EnemiesSharingPoses, NumSharing);
+}
+
+TStatId UEnemyPoseSharingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPoseSharingSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyPoseSharingSubsystem::Deinitialize()
+{
+	Followers.Empty();
+	Groups.Empty();
+	LeaderActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UEnemyPoseSharingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyPoseSharingSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) return;
+	if (Followers.ContainsByPredicate([Enemy](const FPoseSharingFollower& Follower) { return Follower.Enemy == Enemy; })) return;
+
+	FPoseSharingFollower& Follower = Followers.AddDefaulted_GetRef();
+	Follower.Enemy = Enemy;
+}
+
+void UEnemyPoseSharingSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	const int32 Index = Followers.IndexOfByPredicate([Enemy](const FPoseSharingFollower& Follower) { return Follower.Enemy == Enemy; });
+	if (Index == INDEX_NONE) return;
+
+	Unfollow(Followers[Index]);
+	Followers.RemoveAtSwap(Index);
+}
+
+void UEnemyPoseSharingSubsystem::Promote(AEnemy* Enemy)
+{
+	FPoseSharingFollower* Follower = Followers.FindByPredicate([Enemy](const FPoseSharingFollower& Candidate) { return Candidate.Enemy == Enemy; });
+	if (Follower)
+	{
+		Unfollow(*Follower);
+	}
+}
+
+UAnimSequenceBase* UEnemyPoseSharingSubsystem::ChooseSharedAnimation(const AEnemy* Enemy) const
+{
+	if (Enemy->GetEnemyState() != EEnemyState::EES_Patrolling) return nullptr;
+
+	// a following mesh doesn't advance its own montages, so anything playing one animates itself
+	const UAnimInstance* AnimInstance = Enemy->GetMesh()->GetAnimInstance();
+	if (AnimInstance && AnimInstance->IsAnyMontagePlaying()) return nullptr;
+
+	const bool bWalking = Enemy->GetCharacterMovement()->Velocity.SizeSquared2D() > FMath::Square(PoseSharingWalkSpeed);
+	return bWalking ? Enemy->GetSharedWalkAnimation() : Enemy->GetSharedIdleAnimation();
+}
+
+void UEnemyPoseSharingSubsystem::Follow(FPoseSharingFollower& Follower, USkeletalMesh* Mesh, UAnimSequenceBase* Animation)
+{
+	FSharedPoseGroup& Group = FindOrCreateGroup(Mesh, Animation);
+	if (Group.Leaders.Num() == 0) return;
+
+	// the least followed leader, so a crowd spreads over every offset
+	int32 LeaderIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < Group.Leaders.Num(); ++Index)
+	{
+		if (!Group.Leaders[Index].IsValid()) continue;
+		if (LeaderIndex == INDEX_NONE || Group.FollowerCounts[Index] < Group.FollowerCounts[LeaderIndex])
+		{
+			LeaderIndex = Index;
+		}
+	}
+	if (LeaderIndex == INDEX_NONE) return;
+
+	Follower.Leader = Group.Leaders[LeaderIndex];
+	Follower.Key = FSharedPoseKey(Mesh, Animation);
+	Follower.LeaderIndex = LeaderIndex;
+	++Group.FollowerCounts[LeaderIndex];
+	Follower.Enemy->GetMesh()->SetLeaderPoseComponent(Follower.Leader.Get());
+}
+
+void UEnemyPoseSharingSubsystem::Unfollow(FPoseSharingFollower& Follower)
+{
+	if (Follower.LeaderIndex == INDEX_NONE) return;
+
+	// the group may have been rebuilt since, in which case its counts already started over
+	FSharedPoseGroup* Group = Groups.Find(Follower.Key);
+	if (Group && Group->FollowerCounts.IsValidIndex(Follower.LeaderIndex) && Group->FollowerCounts[Follower.LeaderIndex] > 0)
+	{
+		--Group->FollowerCounts[Follower.LeaderIndex];
+	}
+	if (AEnemy* Enemy = Follower.Enemy.Get())
+	{
+		Enemy->GetMesh()->SetLeaderPoseComponent(nullptr);
+	}
+	Follower.Leader.Reset();
+	Follower.LeaderIndex = INDEX_NONE;
+}
+
+FSharedPoseGroup& UEnemyPoseSharingSubsystem::FindOrCreateGroup(USkeletalMesh* Mesh, UAnimSequenceBase* Animation)
+{
+	const FSharedPoseKey Key(Mesh, Animation);
+	FSharedPoseGroup& Group = Groups.FindOrAdd(Key);
+	if (Group.Leaders.ContainsByPredicate([](const TWeakObjectPtr<USkeletalMeshComponent>& Leader) { return Leader.IsValid(); })) return Group;
+
+	// new, or every leader was destroyed along with LeaderActor
+	Group.Leaders.Reset();
+	Group.FollowerCounts.Reset();
+	if (!IsValid(LeaderActor))
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		LeaderActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (LeaderActor == nullptr)
+		{
+			UE_LOG(LogSlash, Warning, TEXT("UEnemyPoseSharingSubsystem couldn't spawn its leader actor, poses won't be shared"));
+			return Group;
+		}
+	}
+
+	const int32 NumVariants = FMath::Max(CVarPoseSharingVariants.GetValueOnGameThread(), 1);
+	const float Length = Animation->GetPlayLength();
+	for (int32 Variant = 0; Variant < NumVariants; ++Variant)
+	{
+		USkeletalMeshComponent* Leader = NewObject<USkeletalMeshComponent>(LeaderActor);
+		Leader->SetSkeletalMeshAsset(Mesh);
+		Leader->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Leader->SetHiddenInGame(true);
+		// never rendered, but followers copy its bones every frame
+		Leader->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		Leader->RegisterComponent();
+		Leader->PlayAnimation(Animation, true);
+		Leader->SetPosition(Length * Variant / NumVariants, false);
+
+		Group.Leaders.Add(Leader);
+		Group.FollowerCounts.Add(0);
+	}
+	INC_DWORD_STAT_BY(STAT_PoseSharingLeaders, NumVariants);
+	return Group;
+}
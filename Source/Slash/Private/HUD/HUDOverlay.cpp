@@ -4,6 +4,7 @@
 #include "HUD/HUDOverlay.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "Components/AttributeComponent.h"
 
 void UHUDOverlay::SetHealthBarPercent(float Percent)
 {
@@ -36,3 +37,71 @@ void UHUDOverlay::SetSouls(int32 Souls)
         SoulsText->SetText(FText::FromString(FString::Printf(TEXT("%d"), Souls)));
     }	
 }
+
+void UHUDOverlay::BindToAttributes(UAttributeComponent* Attributes)
+{
+	UnbindFromAttributes();
+	if (Attributes == nullptr) return;
+
+	BoundAttributes = Attributes;
+	HealthChangedHandle = Attributes->OnHealthChanged.AddWeakLambda(this, [this](float Percent) { PendingHealthPercent = Percent; bHealthDirty = true; });
+	StaminaChangedHandle = Attributes->OnStaminaChanged.AddWeakLambda(this, [this](float Percent) { PendingStaminaPercent = Percent; bStaminaDirty = true; });
+	GoldChangedHandle = Attributes->OnGoldChanged.AddWeakLambda(this, [this](int32 Gold) { PendingGold = Gold; bGoldDirty = true; });
+	SoulsChangedHandle = Attributes->OnSoulsChanged.AddWeakLambda(this, [this](int32 Souls) { PendingSouls = Souls; bSoulsDirty = true; });
+
+	PendingHealthPercent = Attributes->GetHealthPercent();
+	PendingStaminaPercent = Attributes->GetStaminaPercent();
+	PendingGold = Attributes->GetGold();
+	PendingSouls = Attributes->GetSouls();
+	bHealthDirty = bStaminaDirty = bGoldDirty = bSoulsDirty = true;
+}
+
+void UHUDOverlay::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	FlushPendingUpdates();
+}
+
+void UHUDOverlay::NativeDestruct()
+{
+	UnbindFromAttributes();
+
+	Super::NativeDestruct();
+}
+
+void UHUDOverlay::UnbindFromAttributes()
+{
+	if (UAttributeComponent* Attributes = BoundAttributes.Get())
+	{
+		Attributes->OnHealthChanged.Remove(HealthChangedHandle);
+		Attributes->OnStaminaChanged.Remove(StaminaChangedHandle);
+		Attributes->OnGoldChanged.Remove(GoldChangedHandle);
+		Attributes->OnSoulsChanged.Remove(SoulsChangedHandle);
+	}
+	BoundAttributes = nullptr;
+}
+
+void UHUDOverlay::FlushPendingUpdates()
+{
+	if (bHealthDirty)
+	{
+		SetHealthBarPercent(PendingHealthPercent);
+		bHealthDirty = false;
+	}
+	if (bStaminaDirty)
+	{
+		SetStaminaBarPercent(PendingStaminaPercent);
+		bStaminaDirty = false;
+	}
+	if (bGoldDirty)
+	{
+		SetGold(PendingGold);
+		bGoldDirty = false;
+	}
+	if (bSoulsDirty)
+	{
+		SetSouls(PendingSouls);
+		bSoulsDirty = false;
+	}
+}
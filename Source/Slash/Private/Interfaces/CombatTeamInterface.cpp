@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Interfaces/CombatTeamInterface.h"
+
+static constexpr ECombatFlags CombatTeamFlags = ECombatFlags::ECF_Player | ECombatFlags::ECF_Enemy;
+
+// Add default functionality here for any ICombatTeamInterface functions that are not pure virtual.
+ECombatFlags ICombatTeamInterface::GetCombatFlags() const
+{
+	return ECombatFlags::ECF_None;
+}
+
+ECombatFlags ICombatTeamInterface::GetCombatFlagsOf(const AActor* Actor)
+{
+	const ICombatTeamInterface* Combatant = Cast<ICombatTeamInterface>(Actor);
+	return Combatant ? Combatant->GetCombatFlags() : ECombatFlags::ECF_None;
+}
+
+bool ICombatTeamInterface::AreTeammates(const AActor* A, const AActor* B)
+{
+	return EnumHasAnyFlags(GetCombatFlagsOf(A) & GetCombatFlagsOf(B), CombatTeamFlags);
+}
+
+bool ICombatTeamInterface::IsEngageable(const AActor* Actor)
+{
+	const ECombatFlags Flags = GetCombatFlagsOf(Actor);
+	return EnumHasAnyFlags(Flags, ECombatFlags::ECF_Engageable) && !EnumHasAnyFlags(Flags, ECombatFlags::ECF_Dead);
+}
+
+FMaskFilter ICombatTeamInterface::GetTeamMaskFilter(ECombatFlags Flags)
+{
+	// the team bits are the low bits, well inside the 6 bits a mask filter has
+	return (FMaskFilter)(Flags & CombatTeamFlags);
+}
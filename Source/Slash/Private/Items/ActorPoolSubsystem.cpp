@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/ActorPoolSubsystem.h"
+#include "Interfaces/PoolableInterface.h"
+#include "Slash.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actor Pool Hits"), STAT_ActorPoolHits, STATGROUP_Slash);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actor Pool Misses"), STAT_ActorPoolMisses, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actors Pooled"), STAT_ActorsPooled, STATGROUP_Slash);
+
+void UActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (const TPair<TSoftClassPtr<AActor>, int32>& Entry : PrewarmCounts)
+	{
+		if (UClass* ActorClass = Entry.Key.LoadSynchronous())
+		{
+			Prewarm(ActorClass, Entry.Value);
+		}
+	}
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	// high water marks are what the prewarm counts should be tuned to
+	for (const TPair<UClass*, FActorPool>& Entry : Pools)
+	{
+		if (Entry.Key == nullptr) continue;
+		UE_LOG(LogSlash, Log, TEXT("Actor pool %s: %d hits, %d misses, high water mark %d"),
+			*Entry.Key->GetName(), Entry.Value.Hits, Entry.Value.Misses, Entry.Value.HighWaterMark);
+	}
+
+	Super::Deinitialize();
+}
+
+bool UActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+	if (ActorClass == nullptr) return nullptr;
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass);
+	AActor* Actor = nullptr;
+	while (Pool.Inactive.Num() > 0 && Actor == nullptr)
+	{
+		Actor = Pool.Inactive.Pop(false);
+		DEC_DWORD_STAT(STAT_ActorsPooled);
+		if (!IsValid(Actor)) Actor = nullptr;
+	}
+
+	if (Actor)
+	{
+		++Pool.Hits;
+		INC_DWORD_STAT(STAT_ActorPoolHits);
+
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		Actor->SetOwner(Owner);
+		Actor->SetInstigator(Instigator);
+		Actor->SetActorHiddenInGame(false);
+		Actor->SetActorEnableCollision(true);
+		Actor->SetActorTickEnabled(true);
+		if (IPoolableInterface* Poolable = Cast<IPoolableInterface>(Actor))
+		{
+			Poolable->OnAcquiredFromPool();
+		}
+	}
+	else
+	{
+		++Pool.Misses;
+		INC_DWORD_STAT(STAT_ActorPoolMisses);
+
+		// fresh actors run BeginPlay, which is their acquire setup
+		Actor = SpawnPooledActor(ActorClass, Transform, Owner, Instigator);
+		if (Actor == nullptr) return nullptr;
+	}
+
+	// BeginPlay may have acquired from other pools and moved Pools around, so look it up again
+	FActorPool& UsedPool = Pools.FindChecked(ActorClass);
+	++UsedPool.NumInUse;
+	UsedPool.HighWaterMark = FMath::Max(UsedPool.HighWaterMark, UsedPool.NumInUse);
+	return Actor;
+}
+
+void UActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.Inactive.Contains(Actor)) return;
+
+	Deactivate(Actor);
+	Pool.Inactive.Add(Actor);
+	// actors placed in the level were never acquired, so don't count them out
+	Pool.NumInUse = FMath::Max(Pool.NumInUse - 1, 0);
+	INC_DWORD_STAT(STAT_ActorsPooled);
+}
+
+void UActorPoolSubsystem::Prewarm(UClass* ActorClass, int32 Count)
+{
+	if (ActorClass == nullptr || Count <= 0) return;
+
+	const int32 NumAlreadyPooled = Pools.FindOrAdd(ActorClass).Inactive.Num();
+	// spawn far below the level so prewarmed actors never show up for a frame
+	const FTransform HiddenTransform(FVector(0.f, 0.f, -100000.f));
+	for (int32 Index = NumAlreadyPooled; Index < Count; ++Index)
+	{
+		if (AActor* Actor = SpawnPooledActor(ActorClass, HiddenTransform, nullptr, nullptr))
+		{
+			Deactivate(Actor);
+			Pools.FindChecked(ActorClass).Inactive.Add(Actor);
+			INC_DWORD_STAT(STAT_ActorsPooled);
+		}
+	}
+}
+
+AActor* UActorPoolSubsystem::SpawnPooledActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = Owner;
+	SpawnParams.Instigator = Instigator;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+}
+
+void UActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	if (IPoolableInterface* Poolable = Cast<IPoolableInterface>(Actor))
+	{
+		Poolable->OnReleasedToPool();
+	}
+	Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->SetOwner(nullptr);
+}
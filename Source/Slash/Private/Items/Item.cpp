@@ -7,6 +7,8 @@
 #include "NiagaraComponent.h"
 #include "NiagaraFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
+#include "Items/ActorPoolSubsystem.h"
+#include "Combat/CombatFXSubsystem.h"
 
 // Sets default values
 AItem::AItem()
@@ -46,22 +48,61 @@ void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 
 void AItem::SpawnPickupSystem()
 {
-	if (PickupEffect)
-    {
-        UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, PickupEffect, GetActorLocation());
-    }
-
+	if (PickupEffect == nullptr) return;
 
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>())
+	{
+		CombatFX->SpawnEffect(PickupEffect, GetActorLocation());
+	}
+	else
+	{
+		UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, PickupEffect, GetActorLocation());
+	}
 }
 
 void AItem::SpawnPickupSound()
 {
-	if (PickupSound)
+	if (PickupSound == nullptr) return;
+
+	if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>())
+	{
+		CombatFX->PlaySound(PickupSound, GetActorLocation());
+	}
+	else
 	{
 		UGameplayStatics::SpawnSoundAtLocation( this, PickupSound, GetActorLocation());
 	}
 }
 
+void AItem::Despawn()
+{
+	if (UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+	{
+		ActorPool->Release(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void AItem::OnAcquiredFromPool()
+{
+	RunningTime = 0.f;
+	ItemState = EItemState::EIS_Hovering;
+	if (ItemEffect)
+	{
+		ItemEffect->Activate(true);
+	}
+}
+
+void AItem::OnReleasedToPool()
+{
+	if (ItemEffect)
+	{
+		ItemEffect->Deactivate();
+	}
+}
     
 // Called when the game starts or when spawned
 void AItem::BeginPlay()
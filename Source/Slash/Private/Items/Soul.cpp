@@ -20,6 +20,19 @@ void ASoul::BeginPlay()
 {
 	Super::BeginPlay();
 
+	UpdateDesiredZ();
+}
+
+void ASoul::OnAcquiredFromPool()
+{
+	Super::OnAcquiredFromPool();
+
+	// a reused soul starts somewhere new, so find the ground again
+	UpdateDesiredZ();
+}
+
+void ASoul::UpdateDesiredZ()
+{
 	const FVector TraceStartPoint = GetActorLocation();
 	const FVector TraceEndPoint = TraceStartPoint - FVector(0.f, 0.f, 2000.f);
 
@@ -44,7 +57,6 @@ void ASoul::BeginPlay()
 		);
 
 	DesiredZ = OutHit.ImpactPoint.Z + 70;
-
 }
 
 void ASoul::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -57,6 +69,6 @@ void ASoul::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* Ot
 		SpawnPickupSystem();
     	SpawnPickupSound();
 
-    	Destroy();
+    	Despawn();
 	}
 }
\ No newline at end of file
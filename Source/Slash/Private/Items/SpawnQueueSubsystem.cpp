@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/SpawnQueueSubsystem.h"
+#include "Items/ActorPoolSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "Slash.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Queue Drain"), STAT_SpawnQueueDrain, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawns Pending"), STAT_SpawnsPending, STATGROUP_Slash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawns This Frame"), STAT_SpawnsThisFrame, STATGROUP_Slash);
+
+static TAutoConsoleVariable<bool> CVarSpawnDeferred(
+	TEXT("slash.Spawn.Deferred"),
+	true,
+	TEXT("Queue drop spawns and drain them over several frames instead of spawning them immediately."));
+
+static TAutoConsoleVariable<float> CVarSpawnBudgetMs(
+	TEXT("slash.Spawn.BudgetMs"),
+	1.f,
+	TEXT("Game thread time in ms the spawn queue may use per frame, at least one spawn always goes through."));
+
+void USpawnQueueSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_SpawnQueueDrain);
+
+	SET_DWORD_STAT(STAT_SpawnsPending, Pending.Num());
+	if (Pending.Num() == 0)
+	{
+		SET_DWORD_STAT(STAT_SpawnsThisFrame, 0);
+		return;
+	}
+
+	// the player moves, so rank by distance from where they are now
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	const FVector PlayerLocation = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+	for (FQueuedSpawn& Request : Pending)
+	{
+		Request.DistanceSquared = Player ? FVector::DistSquared(Request.Transform.GetLocation(), PlayerLocation) : 0.0;
+	}
+	// sorted descending so the next spawn is popped off the end
+	Pending.Sort([](const FQueuedSpawn& A, const FQueuedSpawn& B)
+	{
+		if (A.DistanceSquared != B.DistanceSquared) return A.DistanceSquared > B.DistanceSquared;
+		return A.Sequence > B.Sequence;
+	});
+
+	const double EndTime = FPlatformTime::Seconds() + CVarSpawnBudgetMs.GetValueOnGameThread() / 1000.0;
+	int32 NumSpawned = 0;
+	do
+	{
+		FQueuedSpawn Request = Pending.Pop(false);
+		SpawnNow(Request);
+		++NumSpawned;
+	}
+	while (Pending.Num() > 0 && FPlatformTime::Seconds() < EndTime);
+
+	SET_DWORD_STAT(STAT_SpawnsThisFrame, NumSpawned);
+}
+
+TStatId USpawnQueueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpawnQueueSubsystem, STATGROUP_Tickables);
+}
+
+void USpawnQueueSubsystem::Deinitialize()
+{
+	Pending.Empty();
+
+	Super::Deinitialize();
+}
+
+bool USpawnQueueSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USpawnQueueSubsystem::QueueSpawnActor(UClass* ActorClass, const FTransform& Transform, TFunction<void(AActor*)> Initializer)
+{
+	if (ActorClass == nullptr || !ActorClass->IsChildOf<AActor>()) return;
+
+	FQueuedSpawn Request;
+	Request.ActorClass = ActorClass;
+	Request.Transform = Transform;
+	Request.Initializer = MoveTemp(Initializer);
+	Request.Sequence = NextSequence++;
+
+	if (!CVarSpawnDeferred.GetValueOnGameThread())
+	{
+		SpawnNow(Request);
+		return;
+	}
+	Pending.Add(MoveTemp(Request));
+}
+
+void USpawnQueueSubsystem::SpawnNow(FQueuedSpawn& Request)
+{
+	UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	if (ActorPool == nullptr) return;
+
+	AActor* Actor = ActorPool->AcquireActor(Request.ActorClass, Request.Transform);
+	if (Actor && Request.Initializer)
+	{
+		Request.Initializer(Actor);
+	}
+}
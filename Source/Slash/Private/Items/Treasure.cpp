@@ -11,6 +11,6 @@ void ATreasure::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor
 	{
 		PickupInterface->AddGold(this);
        	SpawnPickupSound();
-        Destroy();		
+        Despawn();		
 	}
 }
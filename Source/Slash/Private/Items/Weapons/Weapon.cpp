@@ -6,10 +6,20 @@
 #include "Kismet/GameplayStatics.h"
 #include "Components/SphereComponent.h"
 #include "Components/BoxComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
 #include "Interfaces/HitInterface.h"
 #include "Animation/AnimMontage.h"
 #include "NiagaraComponent.h"
+#include "DrawDebugHelpers.h"
+#include "Combat/DamageResolutionSubsystem.h"
+#include "Combat/CombatFXSubsystem.h"
+#include "Combat/ImpactFieldSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarWeaponAsyncTraces(
+    TEXT("slash.Weapon.AsyncTraces"),
+    1,
+    TEXT("0: weapon traces always run synchronously. 1: weapons with bUseAsyncTraces trace asynchronously. 2: every weapon traces asynchronously.\n")
+    TEXT("Async traces run off the game thread and their hits land one frame later."));
 
 
 AWeapon::AWeapon()
@@ -27,11 +37,34 @@ AWeapon::AWeapon()
 	BoxTraceStop->SetupAttachment(GetRootComponent());
 }
 
+void AWeapon::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // last frame's async traces are complete by now, apply them before tracing again
+    if (PendingTraces.Num() > 0)
+    {
+        ConsumeAsyncTraces();
+    }
+    if (bSweeping)
+    {
+        SweepBlade();
+    }
+}
+
 void AWeapon::BeginPlay()
 {
     Super::BeginPlay();
 
     WeaponCollisionBox->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::WeaponBoxOverlap);
+
+    HitQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(WeaponHit), false, this);
+    // pawn capsules, character meshes and breakables, an object type query returns every one the blade crosses
+    HitObjectParams = FCollisionObjectQueryParams();
+    HitObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Pawn);
+    HitObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+    HitObjectParams.AddObjectTypesToQuery(ECollisionChannel::ECC_Destructible);
+    SweepHits.Reserve(16);
 }
 
 void AWeapon::Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator)
@@ -41,12 +74,69 @@ void AWeapon::Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOw
 	SetInstigator(NewInstigator);
     
     AttachMeshToSocket(InParent, InSocketName);
+    // sweep after the owner's mesh has been animated this frame, so the blade pose is current
+    ClearTickPrerequisite();
+    if (InParent)
+    {
+        AddTickPrerequisiteComponent(InParent);
+        TickPrerequisiteParent = InParent;
+    }
     DisableSphereCollision();
     
     PlayEquipSound();
     DeactivateEmbers();
 }
 
+void AWeapon::OnAcquiredFromPool()
+{
+    Super::OnAcquiredFromPool();
+
+    // back to a pickup until someone equips it
+    if (Sphere)
+    {
+        Sphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+    }
+}
+
+void AWeapon::OnReleasedToPool()
+{
+    Super::OnReleasedToPool();
+
+    SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
+    SetInstigator(nullptr);
+    PendingTraces.Reset();
+    ClearTickPrerequisite();
+}
+
+void AWeapon::ClearTickPrerequisite()
+{
+    if (USceneComponent* Parent = TickPrerequisiteParent.Get())
+    {
+        RemoveTickPrerequisiteComponent(Parent);
+    }
+    TickPrerequisiteParent = nullptr;
+}
+
+void AWeapon::SetWeaponCollisionEnabled(ECollisionEnabled::Type CollisionEnabled)
+{
+    // async hits from the end of a swing still land next frame, so the swing is only reset when a new one starts
+    if (CollisionEnabled != ECollisionEnabled::NoCollision)
+    {
+        BeginSwing();
+    }
+
+    if (!bUseSweptHitDetection)
+    {
+        WeaponCollisionBox->SetCollisionEnabled(CollisionEnabled);
+        return;
+    }
+
+    // swept mode never needs the overlap box, the swing starts from the blade's current pose
+    WeaponCollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    bSweeping = CollisionEnabled != ECollisionEnabled::NoCollision;
+    GetBladeTracePoints(PreviousTraceStart, PreviousTraceStop);
+}
+
 void AWeapon::AttachMeshToSocket(USceneComponent* InParent, const FName& InSocketName)
 {
 	FAttachmentTransformRules TransformRules(EAttachmentRule::SnapToTarget, true);
@@ -62,16 +152,122 @@ void AWeapon::WeaponBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 
     if (OutHit.GetActor())
     {
-        if (IsActorSameTypeAs(OutHit.GetActor())) return; //early return to stop enemies hit each other
-        UGameplayStatics::ApplyDamage(OutHit.GetActor(), Damage, GetInstigator()->GetController(), this, UDamageType::StaticClass());
-        ExecuteGetHit(OutHit);
-        CreateFields(OutHit.ImpactPoint);
+        ProcessHit(OutHit);
+    }
+}
+
+void AWeapon::ProcessHit(const FHitResult& Hit)
+{
+    if (IsActorSameTypeAs(Hit.GetActor())) return; //early return to stop enemies hit each other
+
+    // damage, reactions and fields are resolved once per victim at the end of the frame
+    if (UDamageResolutionSubsystem* DamageResolution = GetWorld()->GetSubsystem<UDamageResolutionSubsystem>())
+    {
+        DamageResolution->QueueHit(Hit.GetActor(), this, Damage, Hit.ImpactPoint);
+        return;
+    }
+
+    UGameplayStatics::ApplyDamage(Hit.GetActor(), Damage, GetInstigator()->GetController(), this, UDamageType::StaticClass());
+    ExecuteGetHit(Hit);
+    SpawnImpactFields(Hit.ImpactPoint);
+}
+
+void AWeapon::SpawnImpactFields(const FVector& FieldLocation)
+{
+    // the native path skips impacts with nothing breakable nearby
+    UImpactFieldSubsystem* ImpactFields = GetWorld()->GetSubsystem<UImpactFieldSubsystem>();
+    if (ImpactFields && UImpactFieldSubsystem::IsNativeFieldsEnabled())
+    {
+        ImpactFields->ApplyImpactField(FieldLocation);
+        return;
+    }
+    CreateFields(FieldLocation);
+}
+
+bool AWeapon::GetBladeTracePoints(FVector& OutStart, FVector& OutStop) const
+{
+    // owners whose mesh isn't animated this frame supply the blade pose from a baked trajectory
+    const ABaseCharacter* OwnerCharacter = Cast<ABaseCharacter>(GetOwner());
+    if (OwnerCharacter && OwnerCharacter->GetBakedWeaponTrace(OutStart, OutStop)) return true;
+
+    OutStart = BoxTraceStart->GetComponentLocation();
+    OutStop = BoxTraceStop->GetComponentLocation();
+    return false;
+}
+
+void AWeapon::SweepBlade()
+{
+    FVector CurrentStart;
+    FVector CurrentStop;
+    GetBladeTracePoints(CurrentStart, CurrentStop);
+
+    // fast swings turn the blade a long way in one frame, so split them up by angle
+    const FVector PreviousBlade = (PreviousTraceStop - PreviousTraceStart).GetSafeNormal();
+    const FVector CurrentBlade = (CurrentStop - CurrentStart).GetSafeNormal();
+    const float AngleDegrees = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(FVector::DotProduct(PreviousBlade, CurrentBlade), -1.0, 1.0)));
+    const int32 NumSteps = FMath::Clamp(FMath::CeilToInt32(AngleDegrees / FMath::Max(MaxSweepStepAngle, 1.f)), 1, FMath::Max(MaxSweepSubsteps, 1));
+
+    FVector FromStart = PreviousTraceStart;
+    FVector FromStop = PreviousTraceStop;
+    for (int32 Step = 1; Step <= NumSteps; ++Step)
+    {
+        const float Alpha = (float)Step / NumSteps;
+        const FVector ToStart = FMath::Lerp(PreviousTraceStart, CurrentStart, Alpha);
+        const FVector ToStop = FMath::Lerp(PreviousTraceStop, CurrentStop, Alpha);
+        SweepBladeStep(FromStart, FromStop, ToStart, ToStop);
+        FromStart = ToStart;
+        FromStop = ToStop;
+
+        // a hit can end the swing, e.g. by killing the owner
+        if (!bSweeping) return;
+    }
+
+    PreviousTraceStart = CurrentStart;
+    PreviousTraceStop = CurrentStop;
+}
+
+void AWeapon::SweepBladeStep(const FVector& FromStart, const FVector& FromStop, const FVector& ToStart, const FVector& ToStop)
+{
+    // the blade is a box from BoxTraceStart to BoxTraceStop, moved from its previous centre to its new one
+    const FVector Blade = ToStop - ToStart;
+    const FQuat BladeRotation = FRotationMatrix::MakeFromZ(Blade).ToQuat();
+    const FVector HalfExtent(BoxTraceExtent.X, BoxTraceExtent.Y, Blade.Size() * 0.5 + BoxTraceExtent.Z);
+    const FVector SweepStart = (FromStart + FromStop) * 0.5;
+    const FVector SweepEnd = (ToStart + ToStop) * 0.5;
+
+    const FCollisionShape BladeShape = FCollisionShape::MakeBox(HalfExtent);
+    if (ShouldUseAsyncTraces())
+    {
+        const FTraceHandle Handle = GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Multi, SweepStart, SweepEnd, BladeRotation, HitObjectParams, BladeShape, HitQueryParams);
+        PendingTraces.Add({ Handle, HitRegistry.GetSwingId() });
+        return;
+    }
+
+    SweepHits.Reset();
+    GetWorld()->SweepMultiByObjectType(SweepHits, SweepStart, SweepEnd, BladeRotation, HitObjectParams, BladeShape, HitQueryParams);
+
+    if (bShowBoxDebug)
+    {
+        DrawDebugBox(GetWorld(), SweepEnd, HalfExtent, BladeRotation, SweepHits.Num() > 0 ? FColor::Green : FColor::Red, false, 2.f);
+    }
+
+    for (const FHitResult& Hit : SweepHits)
+    {
+        AActor* HitActor = Hit.GetActor();
+        if (!RegisterHit(HitActor)) continue;
+        ProcessHit(Hit);
     }
 }
 
 void AWeapon::PlayEquipSound()
 {
-        if (EquipSound)
+    if (EquipSound == nullptr) return;
+
+    if (UCombatFXSubsystem* CombatFX = GetWorld()->GetSubsystem<UCombatFXSubsystem>())
+    {
+        CombatFX->PlaySound(EquipSound, GetActorLocation());
+    }
+    else
     {
         UGameplayStatics::PlaySoundAtLocation(this, EquipSound, GetActorLocation());
     }
@@ -93,38 +289,81 @@ void AWeapon::DeactivateEmbers()
     }
 }
 
+void AWeapon::BeginSwing()
+{
+    HitRegistry.BeginSwing();
+    HitQueryParams.ClearIgnoredActors();
+    HitQueryParams.AddIgnoredActor(this);
+    HitQueryParams.AddIgnoredActor(GetOwner());
+    // teammates of the owner are filtered out by the physics query, see ICombatTeamInterface
+    HitQueryParams.IgnoreMask = ICombatTeamInterface::GetTeamMaskFilter(ICombatTeamInterface::GetCombatFlagsOf(GetOwner()));
+}
+
+bool AWeapon::RegisterHit(AActor* HitActor)
+{
+    // one hit per actor per swing, and later traces this swing won't even report it
+    if (HitActor == nullptr || !HitRegistry.RegisterHit(HitActor)) return false;
+    HitQueryParams.AddIgnoredActor(HitActor);
+    return true;
+}
+
 void AWeapon::BoxTrace(FHitResult& BoxHit)
 {
-    const FVector Start = BoxTraceStart->GetComponentLocation();
-    const FVector End = BoxTraceStop->GetComponentLocation();
-    
-    TArray<AActor*> ActorsToIgnore;
-    ActorsToIgnore.Add(this);
-    ActorsToIgnore.Add(GetOwner());
+    FVector Start;
+    FVector End;
+    // a baked pose has no component to take the rotation from, orient the box along the blade like SweepBladeStep
+    const bool bBaked = GetBladeTracePoints(Start, End);
+    const FQuat Rotation = bBaked ? FRotationMatrix::MakeFromZ(End - Start).ToQuat() : BoxTraceStart->GetComponentQuat();
 
-    // Add actor just hit so only has one hit per attack
-    for (AActor* Actor : IgnoreActors)
+    if (ShouldUseAsyncTraces())
     {
-        ActorsToIgnore.AddUnique(Actor);
+        const FTraceHandle Handle = GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Single, Start, End, Rotation, HitObjectParams, FCollisionShape::MakeBox(BoxTraceExtent), HitQueryParams);
+        PendingTraces.Add({ Handle, HitRegistry.GetSwingId() });
+        return;
     }
 
-    UKismetSystemLibrary::BoxTraceSingle(
-        this,
-        Start,
-        End,
-        BoxTraceExtent,
-        BoxTraceStart->GetComponentRotation(),
-        ETraceTypeQuery::TraceTypeQuery1,
-        false,
-        ActorsToIgnore,
-        bShowBoxDebug ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None,
-        BoxHit,
-        true);
+    const bool bHit = GetWorld()->SweepSingleByObjectType(BoxHit, Start, End, Rotation, HitObjectParams, FCollisionShape::MakeBox(BoxTraceExtent), HitQueryParams);
+
+    if (bShowBoxDebug)
+    {
+        DrawDebugBox(GetWorld(), bHit ? BoxHit.Location : End, BoxTraceExtent, Rotation, bHit ? FColor::Green : FColor::Red, false, 5.f);
+    }
 
-    IgnoreActors.AddUnique(BoxHit.GetActor()); 
+    if (!RegisterHit(BoxHit.GetActor()))
+    {
+        BoxHit.Reset();
+    }
+}
+
+bool AWeapon::ShouldUseAsyncTraces() const
+{
+    const int32 AsyncMode = CVarWeaponAsyncTraces.GetValueOnGameThread();
+    return AsyncMode >= 2 || (AsyncMode == 1 && bUseAsyncTraces);
+}
+
+void AWeapon::ConsumeAsyncTraces()
+{
+    UWorld* World = GetWorld();
+    for (int32 Index = 0; Index < PendingTraces.Num(); ++Index)
+    {
+        const FPendingWeaponTrace Pending = PendingTraces[Index];
+        if (!World->QueryTraceData(Pending.Handle, AsyncTraceDatum)) continue;
+
+        // hits from a swing that has since been replaced by a new one don't count
+        if (Pending.SwingId != HitRegistry.GetSwingId()) continue;
+
+        for (const FHitResult& Hit : AsyncTraceDatum.OutHits)
+        {
+            if (RegisterHit(Hit.GetActor()))
+            {
+                ProcessHit(Hit);
+            }
+        }
+    }
+    PendingTraces.Reset();
 }
 
-void AWeapon::ExecuteGetHit(FHitResult& BoxHit)
+void AWeapon::ExecuteGetHit(const FHitResult& BoxHit)
 {
     IHitInterface* HitInterface = Cast<IHitInterface>(BoxHit.GetActor());
         if (HitInterface)
@@ -135,5 +374,5 @@ void AWeapon::ExecuteGetHit(FHitResult& BoxHit)
 
 bool AWeapon::IsActorSameTypeAs(AActor* OtherActor)
 {
-    return GetOwner()->ActorHasTag(TEXT("Enemy")) && OtherActor->ActorHasTag(TEXT("Enemy"));
+    return ICombatTeamInterface::AreTeammates(GetOwner(), OtherActor);
 }
\ No newline at end of file
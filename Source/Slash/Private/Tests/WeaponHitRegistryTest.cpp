@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/Weapons/WeaponHitRegistry.h"
+#include "Items/Weapons/Weapon.h"
+#include "Characters/SlashCharacter.h"
+#include "CollisionQueryParams.h"
+#include "Misc/AutomationTest.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/DefaultPawn.h"
+#include "GameFramework/SpectatorPawn.h"
+#include "GameFramework/Info.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace WeaponHitRegistryTest
+{
+	/** Forwards everything to the real allocator and counts heap allocations made on the test thread while counting */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		void BeginCounting() { CountingThreadId = FPlatformTLS::GetCurrentThreadId(); NumAllocations = 0; bCounting = true; }
+		int32 EndCounting() { bCounting = false; return NumAllocations; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->Realloc(Original, Count, Alignment); }
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->TryRealloc(Original, Count, Alignment); }
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		void CountAllocation()
+		{
+			if (bCounting && FPlatformTLS::GetCurrentThreadId() == CountingThreadId) ++NumAllocations;
+		}
+
+		FMalloc* Inner;
+		uint32 CountingThreadId = 0;
+		int32 NumAllocations = 0;
+		volatile bool bCounting = false;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponHitRegistryTest, "Slash.Weapon.HitRegistry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponHitRegistryTest::RunTest(const FString& Parameters)
+{
+	using namespace WeaponHitRegistryTest;
+
+	static constexpr int32 NumSwings = 1000;
+	static constexpr int32 NumHitsPerVictim = 3;
+
+	// any live actors work as keys, class defaults avoid needing a world
+	const AActor* Weapon = GetDefault<AWeapon>();
+	const AActor* WeaponOwner = GetDefault<ASlashCharacter>();
+	const AActor* Victims[] =
+	{
+		GetDefault<AActor>(),
+		GetDefault<APawn>(),
+		GetDefault<ACharacter>(),
+		GetDefault<ADefaultPawn>(),
+		GetDefault<ASpectatorPawn>(),
+		GetDefault<AInfo>()
+	};
+	constexpr int32 NumVictims = UE_ARRAY_COUNT(Victims);
+	static_assert(NumVictims <= FWeaponHitRegistry::InlineHits, "more victims than inline hits would legitimately allocate");
+
+	// the same state AWeapon keeps per swing, built the way BeginPlay, BeginSwing and RegisterHit do
+	FWeaponHitRegistry Registry;
+	FCollisionQueryParams HitQueryParams(SCENE_QUERY_STAT(WeaponHit), false, Weapon);
+	TArray<FHitResult> SweepHits;
+	SweepHits.Reserve(16);
+	int32 NumSwingsWithWrongHits = 0;
+
+	auto RunSwing = [&](int32 Swing)
+	{
+		Registry.BeginSwing();
+		HitQueryParams.ClearIgnoredActors();
+		HitQueryParams.AddIgnoredActor(Weapon);
+		HitQueryParams.AddIgnoredActor(WeaponOwner);
+
+		int32 NumNewHits = 0;
+		// one sweep per pass, the same victims come back every sweep in a different order every swing
+		for (int32 Pass = 0; Pass < NumHitsPerVictim; ++Pass)
+		{
+			SweepHits.Reset();
+			for (int32 Index = 0; Index < NumVictims; ++Index)
+			{
+				FHitResult& Hit = SweepHits.AddDefaulted_GetRef();
+				Hit.ImpactPoint = FVector(Index, Swing, Pass);
+			}
+			for (int32 Index = 0; Index < SweepHits.Num(); ++Index)
+			{
+				const AActor* Victim = Victims[(Index + Swing + Pass) % NumVictims];
+				if (!Registry.RegisterHit(Victim)) continue;
+				HitQueryParams.AddIgnoredActor(Victim);
+				++NumNewHits;
+			}
+		}
+		// weapon, owner and every victim once
+		if (NumNewHits != NumVictims || Registry.GetNumHits() != NumVictims || HitQueryParams.GetIgnoredActors().Num() != NumVictims + 2)
+		{
+			++NumSwingsWithWrongHits;
+		}
+	};
+
+	// warm up, anything allocated here is kept for every later swing
+	RunSwing(0);
+
+	static FCountingMalloc* CountingMalloc = nullptr;
+	FMalloc* PreviousMalloc = GMalloc;
+	if (CountingMalloc == nullptr)
+	{
+		// never freed, other threads may still be inside it right after GMalloc is restored
+		CountingMalloc = new FCountingMalloc(PreviousMalloc);
+	}
+	GMalloc = CountingMalloc;
+	CountingMalloc->BeginCounting();
+
+	for (int32 Swing = 1; Swing < NumSwings; ++Swing)
+	{
+		RunSwing(Swing);
+	}
+
+	const int32 NumAllocations = CountingMalloc->EndCounting();
+	GMalloc = PreviousMalloc;
+
+	TestEqual(TEXT("Heap allocations after warm up"), NumAllocations, 0);
+	TestEqual(TEXT("Swings without exactly one hit and one ignored actor per victim"), NumSwingsWithWrongHits, 0);
+	TestEqual(TEXT("Swing id after every swing"), Registry.GetSwingId(), (uint32)NumSwings);
+	return true;
+}
+
+#endif
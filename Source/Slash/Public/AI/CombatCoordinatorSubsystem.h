@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatCoordinatorSubsystem.generated.h"
+
+class AEnemy;
+
+struct FAttackTokenHolder
+{
+	TObjectKey<AEnemy> Enemy;
+	double GrantTime = 0.0;
+};
+
+struct FAttackTokenWaiter
+{
+	TObjectKey<AEnemy> Enemy;
+	double WaitStartTime = 0.0;
+	double LastRequestTime = 0.0;
+};
+
+// Attack tokens handed out around one combat target
+struct FAttackTokenSlots
+{
+	TArray<FAttackTokenHolder, TInlineAllocator<4>> Holders;
+	TArray<FAttackTokenWaiter> Waiters;
+};
+
+/**
+ * Caps how many enemies may attack the same target at once.
+ * An enemy inside its attack radius asks for a token before starting its attack timer; without one it
+ * holds position in EES_Circling and asks again on its next AI update. Free tokens go to the waiter with
+ * the best score, nearest first with a bonus for time spent waiting, see the slash.Combat.* console variables.
+ * This bounds the number of attack montages and active weapon boxes per target regardless of crowd size.
+ */
+UCLASS()
+class SLASH_API UCombatCoordinatorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem>*/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem>*/
+
+	/** Returns true if Enemy holds or was just granted an attack token for Target, otherwise queues it */
+	bool RequestAttackToken(AEnemy* Enemy, AActor* Target);
+	void ReleaseAttackToken(AEnemy* Enemy);
+
+	int32 GetNumTokenHolders(AActor* Target) const;
+
+	/**
+	 * Attack requests that left the queue without ever getting a token. Each one is an attack montage that
+	 * never played, so its weapon never swept for hits; this is the proxy for weapon traces avoided, since
+	 * the number of sweeps a swing would have made depends on the montage and frame rate.
+	 */
+	FORCEINLINE int32 GetNumSwingsAvoided() const { return NumSwingsAvoided; }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	void GrantTokens(const AActor* Target, FAttackTokenSlots& Slots, double Now, const AEnemy* Requester = nullptr);
+	void RemoveWaiter(FAttackTokenSlots& Slots, int32 Index, bool bGranted);
+	static bool IsWaitingToAttack(const AEnemy* Enemy);
+	double ScoreWaiter(const FAttackTokenWaiter& Waiter, const FVector& TargetLocation, double Now) const;
+
+	TMap<TObjectKey<AActor>, FAttackTokenSlots> TokenSlots;
+
+	// target each token holder is attacking, so releasing doesn't need to search every target
+	TMap<TObjectKey<AEnemy>, TObjectKey<AActor>> HolderTargets;
+
+	// target each waiter is queued on, so releasing also takes the enemy out of the queue
+	TMap<TObjectKey<AEnemy>, TObjectKey<AActor>> WaiterTargets;
+
+	int32 NumSwingsAvoided = 0;
+};
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Characters/CharacterTypes.h"
+#include "AI/EnemyFlowField.h"
+#include "Enemy/EnemyAnimInstance.h"
+#include "UObject/ObjectKey.h"
+#include "EnemyAISubsystem.generated.h"
+
+class AEnemy;
+class ANavigationData;
+
+// Result of the decision pass for one enemy, applied back on the game thread
+enum class EEnemyAICommand : uint8
+{
+	EEAC_None,
+	EEAC_LoseInterest,
+	EEAC_ChaseTarget,
+	EEAC_StartAttackTimer,
+	EEAC_PatrolTargetReached
+};
+
+// Update rate buckets, enemies further from the player think less often
+enum class EEnemyAIBucket : uint8
+{
+	EEAB_Critical,
+	EEAB_Near,
+	EEAB_Mid,
+	EEAB_Far,
+
+	EEAB_MAX
+};
+
+/**
+ * Owns the decision state of every active AEnemy in struct-of-arrays form.
+ * Each frame the range/state checks for the enemies due an update are evaluated in one ParallelFor pass,
+ * then the resulting commands are applied on the game thread, so AEnemy does not need to tick.
+ * Enemies are bucketed by distance/visibility to the player and far buckets are time-sliced under a
+ * per-frame budget, see the slash.AI.* console variables.
+ * Chasing enemies are steered every frame by sampling one shared flow field per combat target.
+ * Anim snapshots for UEnemyAnimInstance are also pushed from here, only for enemies whose values changed,
+ * along with each enemy mesh's significance for the animation budget allocator (slash.Anim.Budget*).
+ */
+UCLASS()
+class SLASH_API UEnemyAISubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem>*/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	/** </UTickableWorldSubsystem>*/
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	// Pure decision functions, shared by the batched pass and AEnemy's event driven checks
+	static EEnemyAICommand EvaluateCombat(EEnemyState State, bool bHasTarget, double DistanceSquared, double CombatRadiusSquared, double AttackRadiusSquared);
+	static EEnemyAICommand EvaluatePatrol(bool bHasPatrolTarget, double DistanceSquared, double PatrolRadiusSquared);
+
+	static bool IsFlowFieldChaseEnabled();
+
+	FORCEINLINE int32 GetNumUpdatedLastFrame() const { return NumUpdatedLastFrame; }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	void ScheduleUpdates();
+	EEnemyAIBucket ClassifyEnemy(const AEnemy* Enemy, const FVector& PlayerLocation, bool bHasPlayer) const;
+	void GatherEnemyState();
+	void EvaluateDecisions();
+	void ApplyCommands();
+	void SteerChasingEnemies();
+	void PushAnimSnapshots();
+	void UpdateAnimSignificance();
+	void RemoveEnemyAt(int32 Index);
+
+	// flow fields cache navmesh projections, so they have to forget them whenever the navmesh is rebuilt
+	UFUNCTION()
+	void OnNavigationGenerated(ANavigationData* NavData);
+
+	/** Struct-of-arrays decision state, every array has one entry per registered enemy */
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+
+	TArray<FVector> Positions;
+	TArray<FVector> CombatTargetPositions;
+	TArray<FVector> PatrolTargetPositions;
+	TArray<bool> HasCombatTarget;
+	TArray<bool> HasPatrolTarget;
+	TArray<EEnemyState> States;
+	TArray<double> CombatRadiiSquared;
+	TArray<double> AttackRadiiSquared;
+	TArray<double> PatrolRadiiSquared;
+	TArray<EEnemyAICommand> Commands;
+	TArray<uint32> LastUpdateFrames;
+	// resolved once at register time, null for enemies whose anim Blueprint isn't a UEnemyAnimInstance
+	TArray<TWeakObjectPtr<UEnemyAnimInstance>> AnimInstances;
+	// last snapshot pushed to each enemy's UEnemyAnimInstance
+	TArray<FEnemyAnimSnapshot> AnimSnapshots;
+
+	/** Indices of the enemies updated this frame, rebuilt every frame without reallocating */
+	TArray<int32> UpdateList;
+	TArray<int32> DueByBucket[(int32)EEnemyAIBucket::EEAB_MAX];
+
+	uint32 FrameCounter = 0;
+	bool bApplyingCommands = false;
+	int32 NumUpdatedLastFrame = 0;
+
+	/** One flow field per chased target, shared by every enemy chasing it */
+	TMap<TObjectKey<AActor>, TUniquePtr<FEnemyFlowField>> FlowFields;
+
+	// running average of the game thread cost of updating one enemy, used to turn the ms budget into a count
+	double AverageUpdateCostSeconds = 0.0;
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UNavigationSystemV1;
+class ANavigationData;
+
+/**
+ * Grid flow field towards one goal, built on top of the navmesh.
+ * The window stays put while the goal moves around its middle and only slides once the goal gets near
+ * an edge, keeping the walkability of the overlap and projecting just the cells that came into view.
+ * Walkability is cached per cell and height band, so ramps and upper floors get their own answers,
+ * and the owner drops the cache when the navmesh is rebuilt. Moving the goal changes every cell's
+ * distance to it, so the integration pass still covers the whole window.
+ * Every chasing enemy then samples a direction in O(1).
+ */
+class SLASH_API FEnemyFlowField
+{
+public:
+	FEnemyFlowField(double InCellSize, int32 InHalfExtentCells);
+
+	/** Rebuilds the field if the goal moved into a different cell, returns true if it was rebuilt */
+	bool Update(const FVector& GoalLocation, UNavigationSystemV1* NavSystem, const ANavigationData* NavData);
+
+	/** Direction to move from Location, false if Location is outside the field or can't reach the goal */
+	bool Sample(const FVector& Location, FVector& OutDirection) const;
+
+	/** Forgets every projected cell, e.g. after the navmesh changed */
+	void InvalidateWalkability();
+
+	FORCEINLINE int32 GetNumProjectedCells() const { return WalkableCache.Num(); }
+
+	uint32 LastUsedFrame = 0;
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+	bool IsCellWalkable(const FIntPoint& Cell, UNavigationSystemV1* NavSystem, const ANavigationData* NavData);
+	bool IsNearWindowEdge(const FIntPoint& Cell) const;
+	void MoveWindow(const FIntPoint& NewOrigin, UNavigationSystemV1* NavSystem, const ANavigationData* NavData);
+	int32 ToLocalIndex(const FIntPoint& Cell) const;
+	void Integrate();
+
+	double CellSize;
+	int32 HalfExtentCells;
+	int32 GridWidth;
+
+	FIntPoint GoalCell = FIntPoint(MAX_int32, MAX_int32);
+	FIntPoint Origin = FIntPoint::ZeroValue;
+	int32 HeightBand = 0;
+	bool bHasGoal = false;
+	// set when Walkable doesn't match the window any more and every cell has to be looked up again
+	bool bWalkableStale = true;
+
+	/** (world cell, height band) -> walkable, kept across rebuilds until InvalidateWalkability */
+	TMap<FIntVector, bool> WalkableCache;
+
+	/** Local grid around the goal cell, PreviousWalkable is the scratch copy used when the window slides */
+	TArray<bool> Walkable;
+	TArray<bool> PreviousWalkable;
+	TArray<float> Costs;
+	TArray<FVector2f> Directions;
+
+	/** Open list for the integration pass, kept to avoid reallocating */
+	TArray<TPair<float, int32>> OpenList;
+};
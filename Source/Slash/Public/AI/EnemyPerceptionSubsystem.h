@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "Characters/CharacterTypes.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+class AEnemy;
+
+// A line of sight check waiting on an async trace, resolved the frame after it was submitted
+struct FPendingSight
+{
+	TWeakObjectPtr<APawn> Pawn;
+	uint64 CacheKey = 0;
+};
+
+// Cached line of sight answer shared by every enemy/target pair in the same pair of coarse cells
+struct FSightCacheEntry
+{
+	bool bVisible = false;
+	double Time = 0.0;
+};
+
+// One enemy that looks for engageable pawns
+struct FPerceptionObserver
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+	FVector EyeLocation = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+	double SightRadiusSquared = 0.0;
+	double CosPeripheralAngle = 1.0;
+	bool bActive = false;
+
+	// targets inside the sight cone this pass, before line of sight
+	TArray<int32, TInlineAllocator<2>> Candidates;
+	// pawns currently seen, used to only notify on seen/lost transitions
+	TArray<TWeakObjectPtr<APawn>, TInlineAllocator<2>> SeenPawns;
+	TArray<FPendingSight, TInlineAllocator<2>> PendingSights;
+};
+
+// A pawn enemies can see, e.g. the player
+struct FPerceptionTarget
+{
+	TWeakObjectPtr<APawn> Pawn;
+	FVector EyeLocation = FVector::ZeroVector;
+	bool bSensable = false;
+};
+
+/**
+ * World level replacement for a UPawnSensingComponent per enemy.
+ * Targets are hashed into a uniform 2D grid and every observer's sight cone is tested against the
+ * nearby cells in one batched pass, then enemies are only notified when a pawn comes into view.
+ * Line of sight is checked with async traces consumed the next frame, and the answers are cached by
+ * (enemy cell, target cell) so enemies standing near each other share one trace.
+ */
+UCLASS()
+class SLASH_API UEnemyPerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem>*/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem>*/
+
+	void RegisterObserver(AEnemy* Enemy);
+	void UnregisterObserver(AEnemy* Enemy);
+	/** Forgets what Enemy has seen, so pawns still in view are reported again on the next pass */
+	void ForgetSeenPawns(AEnemy* Enemy);
+	void RegisterTarget(APawn* Pawn);
+	void UnregisterTarget(APawn* Pawn);
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	void UpdatePerception();
+	void GatherObservers();
+	void GatherTargets();
+	void BuildTargetGrid();
+	void FindCandidates();
+	void ResolveSightAndNotify();
+	void SubmitSightTrace(const FPerceptionObserver& Observer, const FPerceptionTarget& Target, uint64 CacheKey);
+	void ConsumeSightTraces();
+	void ApplySight(FPerceptionObserver& Observer, APawn* Pawn, bool bVisible);
+	void PurgeSightCache(double Now);
+	uint64 MakeSightCacheKey(const FVector& ObserverLocation, const FVector& TargetLocation) const;
+	FIntPoint GetCell(const FVector& Location) const;
+
+	TArray<FPerceptionObserver> Observers;
+	TArray<FPerceptionTarget> Targets;
+
+	/** Uniform spatial hash, cell -> indices into Targets */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> TargetGrid;
+	double CellSize = 2000.0;
+
+	TMap<uint64, FSightCacheEntry> SightCache;
+	TArray<TPair<FTraceHandle, uint64>> PendingTraces;
+	TSet<uint64> PendingTraceKeys;
+
+	float TimeSinceLastUpdate = 0.f;
+};
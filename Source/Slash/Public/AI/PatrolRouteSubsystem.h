@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PatrolRouteSubsystem.generated.h"
+
+// One precomputed navmesh path between two patrol points, stored as a slice of the shared point table
+struct FPatrolRoute
+{
+	int32 FirstPathPoint = 0;
+	int32 NumPathPoints = 0;
+	float Cost = 0.f;
+};
+
+/**
+ * Precomputes navmesh paths between every pair of patrol points referenced by the enemies in a level,
+ * once at world begin play, so patrolling enemies can follow a cached path instead of issuing a
+ * new path query every time they set off for the next patrol target.
+ * Enemies given patrol points later (pooled or queued spawns) add their missing pairs through AddRoutes.
+ */
+UCLASS()
+class SLASH_API UPatrolRouteSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UWorldSubsystem>*/
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	/** </UWorldSubsystem>*/
+
+	/** Builds the routes between every pair of Targets that isn't cached yet */
+	void AddRoutes(const TArray<AActor*>& Targets);
+
+	/** Copies the cached path From -> To into OutPoints, building it first if needed, returns false if there is no route */
+	bool GetRoutePoints(AActor* From, AActor* To, TArray<FVector>& OutPoints);
+	float GetRouteCost(AActor* From, AActor* To) const;
+
+	/** Called once a move along a cached route was actually accepted */
+	void NotifyRouteFollowed();
+
+	FORCEINLINE int32 GetNumPathQueriesAvoided() const { return NumPathQueriesAvoided; }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	int32 AddPatrolPoint(AActor* Point);
+	void BuildRoute(int32 From, int32 To);
+	const FPatrolRoute* FindRoute(AActor* From, AActor* To, bool& bOutReversed) const;
+	static uint64 MakeRouteKey(int32 From, int32 To);
+
+	UPROPERTY()
+	TArray<AActor*> PatrolPoints;
+
+	UPROPERTY()
+	TMap<AActor*, int32> PatrolPointIndices;
+
+	/** Routes are stored once per unordered pair with the lower point index first, and walked backwards for the reverse trip.
+	 *  Pairs without a navmesh path map to INDEX_NONE so they are not queried again. */
+	TMap<uint64, int32> RouteIndices;
+	TArray<FPatrolRoute> Routes;
+	TArray<FVector> RoutePathPoints;
+
+	int32 NumPathQueriesAvoided = 0;
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Hands a snapshot pushed by gameplay code to an anim instance's worker thread update.
+ * Push and Latch are game thread only, Latch is called from NativeUpdateAnimation so the worker update,
+ * which reads Get from NativeThreadSafeUpdateAnimation, never sees a Push in progress.
+ */
+template<typename SnapshotType>
+struct TAnimSnapshotBuffer
+{
+	void Push(const SnapshotType& InSnapshot)
+	{
+		Pending = InSnapshot;
+		bPending = true;
+	}
+
+	void Latch()
+	{
+		if (bPending)
+		{
+			Latched = Pending;
+			bPending = false;
+		}
+	}
+
+	const SnapshotType& Get() const { return Latched; }
+
+private:
+	SnapshotType Pending;
+	SnapshotType Latched;
+	bool bPending = false;
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * slash.Anim.CompareUpdate, runs N frames with the snapshot path and parallel anim updates, then N frames
+ * with slash.Anim.LegacyUpdate and a.ParallelAnimUpdate 0, so every anim update (player and enemies, graph
+ * included) runs on the game thread like it did before the snapshots. Logs the average game thread frame time
+ * and the game thread time spent in the Slash and enemy anim instances' native updates for both runs.
+ */
+namespace SlashAnimUpdateComparison
+{
+	SLASH_API bool IsRunning();
+	SLASH_API void AddGameThreadCycles(uint64 Cycles);
+
+	// times the enclosing scope while a comparison is running, worker thread updates aren't counted
+	struct FScopedGameThreadTimer
+	{
+		const uint64 StartCycles = IsRunning() && IsInGameThread() ? FPlatformTime::Cycles64() : 0;
+
+		~FScopedGameThreadTimer()
+		{
+			if (StartCycles != 0) AddGameThreadCycles(FPlatformTime::Cycles64() - StartCycles);
+		}
+	};
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Interfaces/HitInterface.h"
+#include "Interfaces/CombatTeamInterface.h"
 #include "Characters/CharacterTypes.h"
 #include "BaseCharacter.generated.h"
 
@@ -12,16 +13,44 @@
 class AWeapon;
 class UAttributeComponent;
 class UAnimMontage;
+class UNiagaraSystem;
+
+// a montage section looked up once at BeginPlay, played by starting the montage at the section's time
+struct FResolvedMontageSection
+{
+	UAnimMontage* Montage = nullptr;
+	int32 SectionIndex = INDEX_NONE;
+	float StartTime = 0.f;
+
+	bool IsValid() const { return Montage != nullptr && SectionIndex != INDEX_NONE; }
+};
+
+enum class EHitReactDirection : uint8
+{
+	EHRD_Front,
+	EHRD_Back,
+	EHRD_Left,
+	EHRD_Right,
+
+	EHRD_MAX
+};
 
 UCLASS()
-class SLASH_API ABaseCharacter : public ACharacter, public IHitInterface
+class SLASH_API ABaseCharacter : public ACharacter, public IHitInterface, public ICombatTeamInterface
 {
 	GENERATED_BODY()
 
 public:
-	ABaseCharacter();
+	ABaseCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 	virtual void Tick(float DeltaTime) override;
 
+	/** <ICombatTeamInterface>*/
+	virtual ECombatFlags GetCombatFlags() const override { return CombatFlags; }
+	/** </ICombatTeamInterface>*/
+
+	/** Baked weapon trace points for the attack playing right now, for when the mesh isn't posed every frame */
+	virtual bool GetBakedWeaponTrace(FVector& OutStart, FVector& OutStop) const { return false; }
+
 protected:
 	/** Combat */
 	virtual void BeginPlay() override;
@@ -45,13 +74,18 @@ protected:
 	void DisableMeshCollision();
 
 	/** Montage */
-	void PlayHitReactMontageMontage(const FName SectionName);
+	void PlayHitReactMontageMontage(EHitReactDirection Direction);
 	virtual void PlayDodgeMontage(); 
 	virtual int32 PlayAttackMontage();
 	virtual void PlaySpecificAttackMontage();
 	virtual int32 PlayDeathMontage();
 	void StopAttackMontage();
 
+	/** Looks up every montage section the character plays, logging an error for any that's missing */
+	virtual void ResolveMontageSections();
+	FResolvedMontageSection ResolveMontageSection(UAnimMontage* Montage, const FName& SectionName) const;
+	void PlayResolvedSection(const FResolvedMontageSection& Section);
+
 	UFUNCTION(BlueprintCallable)
 	FVector GetTranslationWarpTarget();
 
@@ -88,16 +122,23 @@ protected:
 	UPROPERTY(BlueprintReadOnly)
 	TEnumAsByte<EDeathPose> DeathPose;
 
+	// team and state bits, subclasses set their team in the constructor
+	UPROPERTY(VisibleAnywhere, Category = "Combat", meta = (Bitmask, BitmaskEnum = "/Script/Slash.ECombatFlags"))
+	ECombatFlags CombatFlags = ECombatFlags::ECF_None;
+
 private:
-	void PlayMontageSection(UAnimMontage* Montage, const FName& SectionName);
-	int32 PlayRandomMontageSection(UAnimMontage* Montage, const TArray<FName>& SectionNames);
+	int32 PlayRandomMontageSection(const TArray<FResolvedMontageSection>& Sections);
 
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	USoundBase* HitSound;
 
+	// Cascade hit effect, only used while HitEffect isn't set
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	UParticleSystem* HitParticles;
 
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	UNiagaraSystem* HitEffect;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Combat")
 	UAnimMontage* AttackMontage;
 
@@ -122,8 +163,20 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	TArray<FName> DeathMontageSections;
 
+	// the sections above, resolved in ResolveMontageSections
+	TArray<FResolvedMontageSection> AttackSections;
+	TArray<FResolvedMontageSection> DeathSections;
+	FResolvedMontageSection SpecificAttackSection;
+	FResolvedMontageSection DodgeSection;
+	FResolvedMontageSection HitReactSections[(int32)EHitReactDirection::EHRD_MAX];
+
 public:
 	FORCEINLINE TEnumAsByte<EDeathPose> GetDeathPose() const { return DeathPose; }
+	FORCEINLINE AActor* GetCombatTarget() const { return CombatTarget; }
+	FORCEINLINE double GetCombatRadius() const { return CombatRadius; }
+	FORCEINLINE double GetAttackRadius() const { return AttackRadius; }
+	FORCEINLINE UAnimMontage* GetAttackMontage() const { return AttackMontage; }
+	FORCEINLINE UAnimMontage* GetSpecificAttackMontage() const { return SpecificAttackMontage; }
 
 };
 
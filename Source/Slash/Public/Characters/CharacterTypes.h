@@ -40,5 +40,18 @@ enum class EEnemyState : uint8
 	EES_Patrolling UMETA(DisplayName = "Unoccupied"), 
 	EES_Chasing UMETA(DisplayName = "Chasing"),
 	EES_Attacking UMETA(DisplayName = "Attacking"),
-	EES_Engaged UMETA(DisplayName = "Engaged")
-};
\ No newline at end of file
+	EES_Engaged UMETA(DisplayName = "Engaged"),
+	EES_Circling UMETA(DisplayName = "Circling")
+};
+
+// team and state bits read through ICombatTeamInterface, the team bits double as physics mask filter bits
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ECombatFlags : uint8
+{
+	ECF_None = 0 UMETA(Hidden),
+	ECF_Player = 1 << 0 UMETA(DisplayName = "Player"),
+	ECF_Enemy = 1 << 1 UMETA(DisplayName = "Enemy"),
+	ECF_Engageable = 1 << 2 UMETA(DisplayName = "Engageable"),
+	ECF_Dead = 1 << 3 UMETA(DisplayName = "Dead")
+};
+ENUM_CLASS_FLAGS(ECombatFlags);
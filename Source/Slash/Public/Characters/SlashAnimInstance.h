@@ -5,12 +5,36 @@
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
 #include "Characters/CharacterTypes.h"
+#include "Characters/AnimSnapshotBuffer.h"
 #include "SlashAnimInstance.generated.h"
 
 class ASlashCharacter;
 class UCharacterMovementComponent;
+
+// everything the anim graph needs from the character, pushed by ASlashCharacter when it changes
+struct FSlashAnimSnapshot
+{
+	float WalkSpeed = 0.f;
+	float RunSpeed = 0.f;
+	float GroundSpeed = 0.f;
+	bool bIsFalling = false;
+	ECharacterState CharacterState = ECharacterState::ECS_Unequipped;
+	EActionState ActionState = EActionState::EAS_Unoccupied;
+	TEnumAsByte<EDeathPose> DeathPose = EDeathPose::EDP_MAX;
+
+	bool operator==(const FSlashAnimSnapshot& Other) const
+	{
+		return WalkSpeed == Other.WalkSpeed && RunSpeed == Other.RunSpeed && GroundSpeed == Other.GroundSpeed &&
+			bIsFalling == Other.bIsFalling && CharacterState == Other.CharacterState &&
+			ActionState == Other.ActionState && DeathPose == Other.DeathPose;
+	}
+};
+
 /**
- * 
+ * Never reads the character during the update. ASlashCharacter pushes a snapshot when something changes,
+ * the game thread only copies it in, and the graph variables are set in NativeThreadSafeUpdateAnimation
+ * so the whole update can run on a worker thread. slash.Anim.LegacyUpdate goes back to reading the
+ * character on the game thread, for comparing the "Slash Anim Game Thread" stat.
  */
 UCLASS()
 class SLASH_API USlashAnimInstance : public UAnimInstance
@@ -20,6 +44,11 @@ class SLASH_API USlashAnimInstance : public UAnimInstance
 public:
 	virtual void NativeInitializeAnimation() override;
 	virtual void NativeUpdateAnimation(float DeltaTime) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaTime) override;
+
+	FORCEINLINE void PushSnapshot(const FSlashAnimSnapshot& InSnapshot) { Snapshot.Push(InSnapshot); }
+
+	static bool IsLegacyUpdateEnabled();
 
 	UPROPERTY(BlueprintReadOnly)
 	ASlashCharacter* SlashCharacter;
@@ -47,8 +76,12 @@ public:
 
 	UPROPERTY(BlueprintReadOnly, Category = "Movement")
 	TEnumAsByte<EDeathPose> DeathPose;
-};
-
 
+private:
+	void LegacyUpdateFromCharacter();
 
+	TAnimSnapshotBuffer<FSlashAnimSnapshot> Snapshot;
 
+	// the console variable read on the game thread for this update
+	bool bLegacyUpdate = false;
+};
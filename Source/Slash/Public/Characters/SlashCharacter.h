@@ -7,6 +7,7 @@
 #include "InputActionValue.h"
 #include "Characters/CharacterTypes.h"
 #include "Interfaces/PickupInterface.h"
+#include "Characters/SlashAnimInstance.h"
 #include "SlashCharacter.generated.h"
 
 // forward declares
@@ -21,6 +22,7 @@ class ASoul;
 class ATreasure;
 class UAnimMontage;
 class UHUDOverlay;
+class UTargetTrackingComponent;
 
 
 UCLASS()
@@ -39,6 +41,10 @@ public:
 	virtual void AddSouls(ASoul* Soul) override;
 	virtual void AddGold(ATreasure* Treasure) override;
 
+	/** Changes the lock-on range along with the combat radius */
+	UFUNCTION(BlueprintCallable)
+	void SetCombatRadius(double NewCombatRadius);
+
 protected:
 	virtual void BeginPlay() override;
 
@@ -62,7 +68,8 @@ protected:
 	bool CanArm();
 	void Disarm();
 	void Arm();
-	void PlayEquipMontage(const FName SectionName);
+	void PlayEquipMontage(const FResolvedMontageSection& Section);
+	virtual void ResolveMontageSections() override;
 	virtual void Die_Implementation() override;
 
 	UPROPERTY(EditAnywhere, Category = "Input" )
@@ -105,15 +112,11 @@ protected:
 	void HitReactEnd();
 
 private:
-	void SetCombatTargetToClosestEnemyInRange();
 	bool IsUnoccuppied();
 	bool IsOccupied();
 	bool HasEnoughStamina();
 	void InitializeHUDOverlay();
-	void SetHUDHealth();
-	void SetHUDStamina();
-	void SetHUDGold();
-	void SetHUDSouls();
+	void PushAnimSnapshot();
 
 	/** Character Components	*/
 	UPROPERTY(VisibleAnywhere)
@@ -122,6 +125,9 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	UCameraComponent* ViewCamera;
 
+	UPROPERTY(VisibleAnywhere)
+	UTargetTrackingComponent* TargetTracking;
+
 	UPROPERTY(EditAnywhere, Category = "Input")	
 	float WalkSpeed = 200.f;						
 
@@ -140,6 +146,9 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Montages")
 	UAnimMontage* EquipMontage;
 
+	FResolvedMontageSection EquipSection;
+	FResolvedMontageSection UnequipSection;
+
 	
 	ECharacterState CharacterState = ECharacterState::ECS_Unequipped;
 	EActionState ActionState = EActionState::EAS_Unoccupied;
@@ -147,6 +156,10 @@ private:
 	UPROPERTY()
 	UHUDOverlay* HUDOverlay;
 
+	// last snapshot handed to USlashAnimInstance, a new one is only pushed when this differs
+	FSlashAnimSnapshot LastAnimSnapshot;
+	bool bAnimSnapshotPushed = false;
+
 public:
 	/** Setters & Getters	*/
 	FORCEINLINE ECharacterState GetCharacterState() const { return CharacterState; }
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "AttackTrajectoryData.generated.h"
+
+class UAnimMontage;
+class ABaseCharacter;
+class AWeapon;
+
+// Weapon trace points over one montage section, relative to the character root
+USTRUCT()
+struct FBakedAttackTrajectory
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere)
+	UAnimMontage* Montage = nullptr;
+
+	UPROPERTY(VisibleAnywhere)
+	FName Section;
+
+	// montage time the section starts at
+	UPROPERTY(VisibleAnywhere)
+	float SectionStart = 0.f;
+
+	UPROPERTY(VisibleAnywhere)
+	float SampleInterval = 0.f;
+
+	// one sample every SampleInterval, single precision is plenty for points within arm's reach of the root
+	UPROPERTY(VisibleAnywhere)
+	TArray<FVector3f> StartSamples;
+
+	UPROPERTY(VisibleAnywhere)
+	TArray<FVector3f> StopSamples;
+};
+
+/**
+ * BoxTraceStart/BoxTraceStop of a weapon sampled across every section of a character's attack montages.
+ * Baked in the editor with the Bake button, then used by AEnemy to sweep its weapon along the baked path
+ * when its skeletal mesh isn't being fully animated, so hits don't depend on the weapon socket being evaluated.
+ */
+UCLASS(BlueprintType)
+class SLASH_API UAttackTrajectoryData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	const FBakedAttackTrajectory* FindTrajectory(const UAnimMontage* Montage, FName Section) const;
+
+	/** Trace points at SectionTime seconds into the section, relative to the character root */
+	static bool Sample(const FBakedAttackTrajectory& Trajectory, float SectionTime, FVector& OutStart, FVector& OutStop);
+
+#if WITH_EDITOR
+	UFUNCTION(CallInEditor, Category = "Bake")
+	void Bake();
+#endif
+
+private:
+#if WITH_EDITOR
+	void BakeMontage(UAnimMontage* Montage, const FTransform& MeshToRoot, const FTransform& SocketToBone, FName BoneName, const FVector& StartInWeapon, const FVector& StopInWeapon);
+#endif
+
+	/** Character whose mesh and attack montages are sampled */
+	UPROPERTY(EditAnywhere, Category = "Bake")
+	TSubclassOf<ABaseCharacter> CharacterClass;
+
+	/** Weapon whose BoxTraceStart/BoxTraceStop are tracked */
+	UPROPERTY(EditAnywhere, Category = "Bake")
+	TSubclassOf<AWeapon> WeaponClass;
+
+	UPROPERTY(EditAnywhere, Category = "Bake")
+	FName WeaponSocketName = FName("WeaponSocket");
+
+	UPROPERTY(EditAnywhere, Category = "Bake", meta = (ClampMin = "1"))
+	float SampleRate = 30.f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Baked")
+	TArray<FBakedAttackTrajectory> Trajectories;
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatFXSubsystem.generated.h"
+
+class UNiagaraSystem;
+class UParticleSystem;
+class USoundBase;
+class USoundConcurrency;
+
+/**
+ * Single entry point for impact, pickup and equip effects.
+ * Effects come from the engine's component pools instead of a new component per spawn, anything
+ * further than the cull distance from the camera is skipped, and only so many effects and sounds
+ * start per frame. Sounds share a concurrency group that stops the oldest voice once it's full,
+ * so a brawl replaces old impacts instead of stacking hundreds. See the slash.FX.* console variables.
+ */
+UCLASS()
+class SLASH_API UCombatFXSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UWorldSubsystem>*/
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	/** </UWorldSubsystem>*/
+
+	/** Each returns false if the effect was culled or over this frame's budget */
+	bool SpawnEffect(UNiagaraSystem* System, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+	bool SpawnLegacyEffect(UParticleSystem* Particles, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+	bool PlaySound(USoundBase* Sound, const FVector& Location);
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	void BeginFrameIfNeeded();
+	bool IsWithinCullDistance(const FVector& Location) const;
+
+	UPROPERTY(Transient)
+	USoundConcurrency* SoundConcurrency;
+
+	// per frame budget, reset on the first request of each frame
+	uint64 BudgetFrame = 0;
+	int32 EffectsThisFrame = 0;
+	int32 SoundsThisFrame = 0;
+	FVector ViewLocation = FVector::ZeroVector;
+	bool bHasViewLocation = false;
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "DamageResolutionSubsystem.generated.h"
+
+class AWeapon;
+
+struct FPendingHit
+{
+	TWeakObjectPtr<AActor> Victim;
+	TWeakObjectPtr<AWeapon> Weapon;
+	TWeakObjectPtr<AActor> Hitter;
+	TWeakObjectPtr<AController> InstigatorController;
+	float Damage = 0.f;
+	FVector ImpactPoint = FVector::ZeroVector;
+};
+
+// All of this frame's hits on one victim, merged
+struct FResolvedVictim
+{
+	int32 FirstHit = INDEX_NONE;
+	float TotalDamage = 0.f;
+};
+
+/**
+ * Collects weapon hits during the frame and resolves them in one pass once all actors have ticked.
+ * Several hits on the same victim in a frame are merged, damage is applied for every victim first
+ * and then each victim gets one GetHit reaction (sound, particles, montage, health bar) and one
+ * field spawn, instead of a full reaction chain per hit. See slash.Combat.BatchDamage.
+ */
+UCLASS()
+class SLASH_API UDamageResolutionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem>*/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem>*/
+
+	/** Queues Weapon hitting Victim, or resolves it straight away if batching is off */
+	void QueueHit(AActor* Victim, AWeapon* Weapon, float Damage, const FVector& ImpactPoint);
+
+	FORCEINLINE int32 GetNumPendingHits() const { return PendingHits.Num(); }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	void ResolveHits();
+	static void ApplyHitDamage(const FPendingHit& Hit, float Damage);
+	static void DispatchHitReaction(const FPendingHit& Hit);
+
+	TArray<FPendingHit> PendingHits;
+
+	/** Reused every frame, hits being resolved are swapped in here so new hits can queue meanwhile */
+	TArray<FPendingHit> ResolvingHits;
+	TArray<FResolvedVictim> ResolvedVictims;
+	TMap<TObjectKey<AActor>, int32> VictimIndices;
+};
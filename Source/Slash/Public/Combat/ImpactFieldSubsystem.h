@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ImpactFieldSubsystem.generated.h"
+
+class ABreakableActor;
+class AFieldSystemActor;
+class URadialFalloff;
+class URadialVector;
+class UCullingField;
+
+/**
+ * Native replacement for the weapon Blueprint CreateFields event.
+ * A strain and velocity field is only applied when a registered breakable is within reach of the
+ * impact, at most slash.Field.MaxPerFrame times per frame, through one field system actor and one set
+ * of field nodes that are kept for the whole world instead of spawning field actors per hit.
+ * Field strength and reach are set in [/Script/Slash.ImpactFieldSubsystem] in DefaultGame.ini.
+ */
+UCLASS(Config = Game)
+class SLASH_API UImpactFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UWorldSubsystem>*/
+	virtual void Deinitialize() override;
+	/** </UWorldSubsystem>*/
+
+	/** Breakables register while they're in play so impacts know if there's anything to fracture */
+	void RegisterBreakable(ABreakableActor* Breakable);
+	void UnregisterBreakable(ABreakableActor* Breakable);
+
+	/** Returns false if the field was skipped, either nothing breakable is close or the frame's budget is spent */
+	bool ApplyImpactField(const FVector& Location);
+
+	static bool IsNativeFieldsEnabled();
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	bool HasBreakableInRange(const FVector& Location);
+	bool EnsureFieldSystem();
+
+	UPROPERTY(Config)
+	float FieldRadius = 200.f;
+
+	UPROPERTY(Config)
+	float StrainMagnitude = 500000.f;
+
+	UPROPERTY(Config)
+	float VelocityMagnitude = 500.f;
+
+	TArray<TWeakObjectPtr<ABreakableActor>> Breakables;
+
+	UPROPERTY()
+	AFieldSystemActor* FieldSystemActor;
+
+	// reused for every impact, applying a field copies the nodes into the solver's command
+	UPROPERTY()
+	URadialFalloff* VelocityFalloff;
+
+	UPROPERTY()
+	URadialVector* VelocityVector;
+
+	UPROPERTY()
+	UCullingField* VelocityCulling;
+
+	uint64 BudgetFrame = 0;
+	int32 FieldsThisFrame = 0;
+};
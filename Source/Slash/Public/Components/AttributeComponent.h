@@ -6,6 +6,9 @@
 #include "Components/ActorComponent.h"
 #include "AttributeComponent.generated.h"
 
+// broadcast only when the value actually changed
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAttributePercentChanged, float /*Percent*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAttributeCountChanged, int32 /*Count*/);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SLASH_API UAttributeComponent : public UActorComponent
@@ -17,6 +20,11 @@ public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	void RegenStamina(float DeltaTime);
 
+	FOnAttributePercentChanged OnHealthChanged;
+	FOnAttributePercentChanged OnStaminaChanged;
+	FOnAttributeCountChanged OnGoldChanged;
+	FOnAttributeCountChanged OnSoulsChanged;
+
 protected:
 	virtual void BeginPlay() override;
 
@@ -47,8 +55,12 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
 	int32 Souls;	
 
+	void SetHealth(float NewHealth);
+	void SetStamina(float NewStamina);
+
 public:
 	void ReceiveDamage(float Damage);
+	void ResetAttributes();
 	void UseStamina(float StaminaCost);
 	float GetHealthPercent();
 	float GetStaminaPercent();
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SphereComponent.h"
+#include "TargetTrackingComponent.generated.h"
+
+/**
+ * Lock-on target for the player.
+ * The sphere keeps a candidate list of enemies up to date from overlap begin/end events, and every
+ * ScoreInterval seconds the candidates are scored by squared distance and how close they are to where
+ * the camera looks. The current target is only replaced by one that scores better by SwitchMargin,
+ * so two enemies at similar distances don't make the target flicker.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class SLASH_API UTargetTrackingComponent : public USphereComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTargetTrackingComponent();
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Resizes the sphere and picks a target again straight away */
+	void SetTrackingRadius(float Radius);
+
+	/** Drops the current target and picks again straight away, e.g. after the radius changed */
+	void RefreshTarget();
+
+protected:
+	virtual void BeginPlay() override;
+
+	UFUNCTION()
+	void OnCandidateBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void OnCandidateEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+
+private:
+	void AddCandidate(AActor* Actor);
+	void ScoreCandidates();
+	float ScoreCandidate(const AActor* Candidate, const FVector& Origin, const FVector& ViewDirection) const;
+
+	UPROPERTY(EditAnywhere, Category = "Targeting", meta = (ClampMin = "0"))
+	float ScoreInterval = 0.1f;
+
+	// how much looking straight at a candidate counts against it being at the edge of the radius
+	UPROPERTY(EditAnywhere, Category = "Targeting", meta = (ClampMin = "0"))
+	float FacingWeight = 0.5f;
+
+	// a new target has to score this much better than the current one to take over
+	UPROPERTY(EditAnywhere, Category = "Targeting", meta = (ClampMin = "0"))
+	float SwitchMargin = 0.15f;
+
+	UPROPERTY(EditAnywhere, Category = "Targeting")
+	bool bShowDebug = false;
+
+	// enemies overlapping the sphere, kept between frames so scoring never allocates
+	TArray<TWeakObjectPtr<AActor>> Candidates;
+
+	TWeakObjectPtr<AActor> CurrentTarget;
+
+public:
+	FORCEINLINE AActor* GetTarget() const { return CurrentTarget.Get(); }
+};
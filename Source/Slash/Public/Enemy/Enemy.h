@@ -8,10 +8,12 @@
 #include "Enemy.generated.h"
 
 class UHealthBarComponent;
-class UPawnSensingComponent;
 class AAIController;
 class AWeapon;
 class ASoul;
+class UAttackTrajectoryData;
+class UAnimSequenceBase;
+enum class EEnemyAICommand : uint8;
 
 UCLASS()
 class SLASH_API AEnemy : public ABaseCharacter
@@ -19,10 +21,9 @@ class SLASH_API AEnemy : public ABaseCharacter
 	GENERATED_BODY()
 
 public:
-	AEnemy();
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 
 	/** <AActor>*/
-	virtual void Tick(float DeltaTime) override;
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 	virtual void Destroyed() override;	
 	/** </AActor>*/
@@ -31,10 +32,29 @@ public:
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 	/** </IHitInterface>*/
 
+	/** <ABaseCharacter>*/
+	virtual bool GetBakedWeaponTrace(FVector& OutStart, FVector& OutStop) const override;
+	/** </ABaseCharacter>*/
+
+	/** Called by UEnemyAISubsystem with the result of the batched decision pass */
+	void ApplyAICommand(EEnemyAICommand Command);
+
+	/** Flow field chase, called every frame by UEnemyAISubsystem while chasing */
+	void SteerChase(const FVector& Direction);
+	void ChaseByPathfinding();
+
+	/** Pooling, see UEnemyPoolSubsystem */
+	void DeactivateForPool();
+	void ActivateFromPool(const FTransform& Transform, AActor* InPatrolTarget, const TArray<AActor*>& InPatrolTargets);
+	void SetPatrolTargets(AActor* InPatrolTarget, const TArray<AActor*>& InPatrolTargets);
+
+	/** Called by UEnemyPerceptionSubsystem when a pawn comes into view */
+	void PawnSeen(APawn* SeenPawn);
 
 protected:
 	/** <AActor>*/
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	/** </AActor>*/
 
 	/** <ABaseCharacter>*/
@@ -53,8 +73,11 @@ private:
 
 	/** AI Behaviour*/
 	void InitializeEnemy();	
+	void RegisterWithSubsystems();
+	void UnregisterFromSubsystems();
+	void DeathTimerFinished();
 	void CheckCombatTarget();
-	void CheckPatrolTarget();
+	void PatrolTargetReached();
 	void PatrolTimerFinished();
 	void HideHealthBar();
 	void ShowHealthBar();
@@ -68,24 +91,30 @@ private:
 	bool IsAttacking();
 	bool IsDead();
 	bool IsEngaged();
+	bool IsCircling();
+	bool ShouldUseBakedTrajectory() const;
+	void StopSharingPose();
 	void ClearPatrolTimer();
+	void RequestAttack();
+	void StartCircling();
+	void ReleaseAttackToken();
 	void StartAttackTimer();
 	void ClearAttackTimer();
 //	bool InTargetRange(AActor* Target, double AcceptanceRadius);
 	void MoveToTarget(AActor* Target);
+	bool MoveAlongPatrolRoute(AActor* From, AActor* To);
 	AActor* ChoosePatrolTarget();
 	void SpawnDefaultWeapon();
 	
 
-
-	UFUNCTION()
-	void PawnSeen(APawn* SeenPawn); // Callback for OnPawnSeen in UPawnSensingComponent
-
 	UPROPERTY(VisibleAnywhere)
 	UHealthBarComponent* HealthBarWidget;
 
-	UPROPERTY(VisibleAnywhere)
-	UPawnSensingComponent* PawnSensing;
+	UPROPERTY(EditAnywhere, Category = "Perception")
+	float SightRadius = 4000.f;
+
+	UPROPERTY(EditAnywhere, Category = "Perception")
+	float PeripheralVisionAngle = 45.f;
 
 	UPROPERTY(EditAnywhere, Category = Combat)
 	TSubclassOf<AWeapon> WeaponClass;
@@ -99,6 +128,10 @@ private:
 	UPROPERTY(EditAnywhere, Category = Combat)
 	double AcceptanceRadius = 50.f;
 
+	// weapon paths for this enemy's attacks, swept instead of the weapon sockets while the mesh is throttled or off screen
+	UPROPERTY(EditAnywhere, Category = Combat)
+	UAttackTrajectoryData* AttackTrajectories;
+
 	UPROPERTY()
 	AAIController* EnemyAIController;
 
@@ -108,6 +141,13 @@ private:
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	TArray<AActor*> PatrolTargets;
 
+	// patrol point we last arrived at, the start of the cached route to PatrolTarget
+	UPROPERTY()
+	AActor* PreviousPatrolTarget;
+
+	// reused for every patrol leg so following a cached route doesn't reallocate
+	TArray<FVector> PatrolRoutePoints;
+
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	double PatrolRadius = 200.f;
 
@@ -133,12 +173,34 @@ private:
 	UPROPERTY(EditAnywhere, Category = Combat)
 	float ChasingSpeed = 300.f;	
 
+	// set while chasing with MoveTo because the flow field couldn't be used
+	bool bChasingByPathfinding = false;
+
+	// how long the corpse stays before the enemy goes back to the pool
 	UPROPERTY(EditAnywhere, Category = Combat)
 	float DeathLifeSpan = 4.f;
+
+	FTimerHandle DeathTimer;
 	
 	UPROPERTY(EditAnywhere, Category = Combat)
 	TSubclassOf<ASoul> SoulClass;
 
+	// cycles patrolling enemies share through UEnemyPoseSharingSubsystem, unset to always animate individually
+	UPROPERTY(EditAnywhere, Category = "Animation Sharing")
+	UAnimSequenceBase* SharedWalkAnimation;
+
+	UPROPERTY(EditAnywhere, Category = "Animation Sharing")
+	UAnimSequenceBase* SharedIdleAnimation;
+
+public:
+	FORCEINLINE EEnemyState GetEnemyState() const { return EnemyState; }
+	FORCEINLINE AActor* GetPatrolTarget() const { return PatrolTarget; }
+	FORCEINLINE const TArray<AActor*>& GetPatrolTargets() const { return PatrolTargets; }
+	FORCEINLINE double GetPatrolRadius() const { return PatrolRadius; }
+	FORCEINLINE float GetSightRadius() const { return SightRadius; }
+	FORCEINLINE float GetPeripheralVisionAngle() const { return PeripheralVisionAngle; }
+	FORCEINLINE UAnimSequenceBase* GetSharedWalkAnimation() const { return SharedWalkAnimation; }
+	FORCEINLINE UAnimSequenceBase* GetSharedIdleAnimation() const { return SharedIdleAnimation; }
 };
 
 
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "Characters/CharacterTypes.h"
+#include "Characters/AnimSnapshotBuffer.h"
+#include "EnemyAnimInstance.generated.h"
+
+// what the enemy anim graph needs, pushed by UEnemyAISubsystem when it changes
+struct FEnemyAnimSnapshot
+{
+	// starts as NoState so the first push after registering always goes through
+	EEnemyState EnemyState = EEnemyState::EES_NoState;
+	float GroundSpeed = 0.f;
+	TEnumAsByte<EDeathPose> DeathPose = EDeathPose::EDP_MAX;
+	bool bLocomotionOnly = false;
+
+	bool operator==(const FEnemyAnimSnapshot& Other) const
+	{
+		return EnemyState == Other.EnemyState && GroundSpeed == Other.GroundSpeed &&
+			DeathPose == Other.DeathPose && bLocomotionOnly == Other.bLocomotionOnly;
+	}
+};
+
+/**
+ * Native parent for the enemy anim Blueprints.
+ * The graph variables come from a snapshot UEnemyAISubsystem pushes for every registered enemy, copied in
+ * on the game thread and applied in NativeThreadSafeUpdateAnimation, so the Blueprint event graph doesn't
+ * need to read the enemy and the update can run on a worker thread. bLocomotionOnly is set while the enemy
+ * is patrolling with no montage playing, for graphs to skip straight to the locomotion state machine.
+ */
+UCLASS()
+class SLASH_API UEnemyAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	virtual void NativeUpdateAnimation(float DeltaTime) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaTime) override;
+
+	FORCEINLINE void PushSnapshot(const FEnemyAnimSnapshot& InSnapshot) { Snapshot.Push(InSnapshot); }
+
+	UPROPERTY(BlueprintReadOnly, Category = "Movement")
+	EEnemyState EnemyState = EEnemyState::EES_Patrolling;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Movement")
+	float GroundSpeed = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Movement")
+	TEnumAsByte<EDeathPose> DeathPose = EDeathPose::EDP_Death1;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Movement")
+	bool bLocomotionOnly = false;
+
+private:
+	TAnimSnapshotBuffer<FEnemyAnimSnapshot> Snapshot;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyPoolSubsystem.generated.h"
+
+class AEnemy;
+
+USTRUCT()
+struct FEnemyPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AEnemy*> Inactive;
+};
+
+/**
+ * Recycles dead enemies instead of destroying them.
+ * A released enemy is hidden with its collision, movement, AI and controller switched off but keeps its
+ * components and attached weapon, so spawning the next wave reuses it without a SpawnActor, a weapon
+ * spawn or any constructor time subobject creation.
+ * Each class keeps at most slash.EnemyPool.MaxPerClass inactive enemies, releases beyond that are destroyed.
+ */
+UCLASS()
+class SLASH_API UEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Reuses a pooled enemy of EnemyClass if there is one, otherwise spawns a new one */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool", meta = (AutoCreateRefTerm = "PatrolTargets"))
+	AEnemy* SpawnEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform, AActor* PatrolTarget, const TArray<AActor*>& PatrolTargets);
+
+	/** Deactivates Enemy and keeps it for the next SpawnEnemy of the same class, or destroys it if the pool is full */
+	void ReleaseEnemy(AEnemy* Enemy);
+
+	/** Spawns Count inactive enemies up front, e.g. while a level loads */
+	UFUNCTION(BlueprintCallable, Category = "Enemy Pool")
+	void Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count);
+
+	int32 GetNumPooled(TSubclassOf<AEnemy> EnemyClass) const;
+	FORCEINLINE int32 GetNumReused() const { return NumReused; }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	AEnemy* SpawnNewEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform);
+
+	UPROPERTY()
+	TMap<UClass*, FEnemyPool> Pools;
+
+	int32 NumReused = 0;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "EnemyPoseSharingSubsystem.generated.h"
+
+class AEnemy;
+class USkeletalMesh;
+class UAnimSequenceBase;
+class USkeletalMeshComponent;
+
+// hidden leader meshes playing one animation, each started at a different point of the cycle
+// leaders are owned by LeaderActor, so they go away with it, e.g. on a level travel
+struct FSharedPoseGroup
+{
+	TArray<TWeakObjectPtr<USkeletalMeshComponent>> Leaders;
+	TArray<int32> FollowerCounts;
+};
+
+using FSharedPoseKey = TPair<TObjectKey<USkeletalMesh>, TObjectKey<UAnimSequenceBase>>;
+
+struct FPoseSharingFollower
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+	// what the enemy currently copies its pose from, LeaderIndex is INDEX_NONE while it animates itself
+	TWeakObjectPtr<USkeletalMeshComponent> Leader;
+	FSharedPoseKey Key;
+	int32 LeaderIndex = INDEX_NONE;
+};
+
+/**
+ * Lets patrolling enemies share poses instead of each evaluating the same walk and idle cycles.
+ * An enemy that is patrolling with no montage playing follows one of a few leader meshes playing its
+ * SharedWalkAnimation or SharedIdleAnimation (staggered so neighbours don't move in lockstep). It's given
+ * back its own animation as soon as it leaves patrolling or a montage is about to play, see AEnemy::StopSharingPose.
+ * See the slash.Anim.PoseSharing* console variables.
+ */
+UCLASS()
+class SLASH_API UEnemyPoseSharingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem>*/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+	/** </UTickableWorldSubsystem>*/
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Gives Enemy its own animation back straight away, call before playing a montage on it */
+	void Promote(AEnemy* Enemy);
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	UAnimSequenceBase* ChooseSharedAnimation(const AEnemy* Enemy) const;
+	void Follow(FPoseSharingFollower& Follower, USkeletalMesh* Mesh, UAnimSequenceBase* Animation);
+	void Unfollow(FPoseSharingFollower& Follower);
+	FSharedPoseGroup& FindOrCreateGroup(USkeletalMesh* Mesh, UAnimSequenceBase* Animation);
+
+	TArray<FPoseSharingFollower> Followers;
+	TMap<FSharedPoseKey, FSharedPoseGroup> Groups;
+
+	// owns every leader component
+	UPROPERTY()
+	AActor* LeaderActor;
+};
@@ -8,6 +8,7 @@
 
 class UProgressBar;
 class UTextBlock;
+class UAttributeComponent;
 
 UCLASS()
 class SLASH_API UHUDOverlay : public UUserWidget
@@ -20,7 +21,17 @@ public:
 	void SetGold(int32 Gold);
 	void SetSouls(int32 Souls);
 
+	/** Follows Attributes' change events from now on, starting from its current values */
+	void BindToAttributes(UAttributeComponent* Attributes);
+
+protected:
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+	virtual void NativeDestruct() override;
+
 private:
+	void UnbindFromAttributes();
+	void FlushPendingUpdates();
+
 	UPROPERTY(meta = (BindWidget))
 	UProgressBar* PlayerHealthBar;
 
@@ -32,6 +43,22 @@ private:
 
 	UPROPERTY(meta = (BindWidget))
 	UTextBlock* SoulsText;
+
+	// attribute changes are only written down when they arrive, each widget is updated once in the next tick
+	float PendingHealthPercent = 1.f;
+	float PendingStaminaPercent = 1.f;
+	int32 PendingGold = 0;
+	int32 PendingSouls = 0;
+	bool bHealthDirty = false;
+	bool bStaminaDirty = false;
+	bool bGoldDirty = false;
+	bool bSoulsDirty = false;
+
+	TWeakObjectPtr<UAttributeComponent> BoundAttributes;
+	FDelegateHandle HealthChangedHandle;
+	FDelegateHandle StaminaChangedHandle;
+	FDelegateHandle GoldChangedHandle;
+	FDelegateHandle SoulsChangedHandle;
 };
 
 
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "Characters/CharacterTypes.h"
+#include "CombatTeamInterface.generated.h"
+
+// This class does not need to be modified.
+UINTERFACE(MinimalAPI)
+class UCombatTeamInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Team and state of a combatant as a bitmask, used instead of actor tags wherever combat code
+ * asks "is this an enemy", "is this dead" or "can this be engaged".
+ * The team bits are also set as the mask filter of the combatant's bodies, so a query with
+ * IgnoreMask set to GetTeamMaskFilter skips same-team actors inside the physics query itself.
+ */
+class SLASH_API ICombatTeamInterface
+{
+	GENERATED_BODY()
+
+	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
+public:
+	virtual ECombatFlags GetCombatFlags() const;
+
+	/** Flags of any actor, ECF_None if it isn't a combatant */
+	static ECombatFlags GetCombatFlagsOf(const AActor* Actor);
+	static bool AreTeammates(const AActor* A, const AActor* B);
+	static bool IsEngageable(const AActor* Actor);
+	static FMaskFilter GetTeamMaskFilter(ECombatFlags Flags);
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PoolableInterface.generated.h"
+
+// This class does not need to be modified.
+UINTERFACE(MinimalAPI)
+class UPoolableInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actors recycled by UActorPoolSubsystem.
+ * A freshly spawned actor runs BeginPlay as usual; a reused one gets OnAcquiredFromPool instead,
+ * after it has been moved to its new transform, so any BeginPlay setup that depends on where the
+ * actor is has to be redone there.
+ */
+class SLASH_API IPoolableInterface
+{
+	GENERATED_BODY()
+
+	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
+public:
+	virtual void OnAcquiredFromPool();
+	virtual void OnReleasedToPool();
+};
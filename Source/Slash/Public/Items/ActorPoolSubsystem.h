@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.generated.h"
+
+USTRUCT()
+struct FActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> Inactive;
+
+	int32 NumInUse = 0;
+	int32 HighWaterMark = 0;
+	int32 Hits = 0;
+	int32 Misses = 0;
+};
+
+/**
+ * Reuses released actors instead of destroying them and spawning new ones, for souls, treasure and weapons.
+ * Acquire takes an inactive actor of the exact class if there is one and otherwise spawns it, Release hides
+ * it and switches its collision and tick off. Actors implementing IPoolableInterface are told about both.
+ * Classes listed in PrewarmCounts ([/Script/Slash.ActorPoolSubsystem] in DefaultGame.ini) are spawned up
+ * front when the world begins play.
+ */
+UCLASS(Config = Game)
+class SLASH_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UWorldSubsystem>*/
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	/** </UWorldSubsystem>*/
+
+	template<typename T>
+	T* Acquire(TSubclassOf<T> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr)
+	{
+		return Cast<T>(AcquireActor(ActorClass, Transform, Owner, Instigator));
+	}
+
+	AActor* AcquireActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+	void Release(AActor* Actor);
+	void Prewarm(UClass* ActorClass, int32 Count);
+
+	/** Hits, misses and high water mark for ActorClass, nullptr if it was never pooled */
+	const FActorPool* GetPool(UClass* ActorClass) const { return Pools.Find(ActorClass); }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	AActor* SpawnPooledActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+	void Deactivate(AActor* Actor);
+
+	UPROPERTY(Config)
+	TMap<TSoftClassPtr<AActor>, int32> PrewarmCounts;
+
+	UPROPERTY()
+	TMap<UClass*, FActorPool> Pools;
+};
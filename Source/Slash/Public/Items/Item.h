@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Interfaces/PoolableInterface.h"
 #include "Item.generated.h"
 
 class USphereComponent;
@@ -17,7 +18,7 @@ enum class EItemState : uint8
 };
 
 UCLASS()
-class SLASH_API AItem : public AActor
+class SLASH_API AItem : public AActor, public IPoolableInterface
 {
 	GENERATED_BODY()
 	
@@ -28,6 +29,14 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	/** <IPoolableInterface>*/
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReleasedToPool() override;
+	/** </IPoolableInterface>*/
+
+	// hands the item back to UActorPoolSubsystem, use instead of Destroy
+	void Despawn();
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
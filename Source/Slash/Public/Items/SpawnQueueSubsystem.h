@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/Identity.h"
+#include "SpawnQueueSubsystem.generated.h"
+
+USTRUCT()
+struct FQueuedSpawn
+{
+	GENERATED_BODY()
+
+	// referenced so the class can't be collected while the spawn waits in the queue
+	UPROPERTY()
+	TSubclassOf<AActor> ActorClass;
+
+	FTransform Transform;
+	TFunction<void(AActor*)> Initializer;
+	// queue order, breaks ties so the drain order is deterministic
+	uint64 Sequence = 0;
+	double DistanceSquared = 0.0;
+};
+
+/**
+ * Spreads bursts of drop spawns (souls from mass enemy deaths, treasure from smashed breakables)
+ * over several frames. Requests are drained nearest to the player first, in queue order for equal
+ * distances, until the per-frame budget is spent, see the slash.Spawn.* console variables.
+ * Actors come from UActorPoolSubsystem and the initializer runs right after the actor is placed.
+ */
+UCLASS()
+class SLASH_API USpawnQueueSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem>*/
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+	/** </UTickableWorldSubsystem>*/
+
+	// T is only deduced from ActorClass, so the initializer can be a plain lambda
+	template<typename T>
+	void QueueSpawn(TSubclassOf<T> ActorClass, const FTransform& Transform, TFunction<void(typename TIdentity<T>::Type*)> Initializer = nullptr)
+	{
+		if (Initializer)
+		{
+			QueueSpawnActor(ActorClass, Transform, [Initializer = MoveTemp(Initializer)](AActor* Actor)
+			{
+				if (T* Typed = Cast<T>(Actor)) Initializer(Typed);
+			});
+		}
+		else
+		{
+			QueueSpawnActor(ActorClass, Transform, nullptr);
+		}
+	}
+
+	void QueueSpawnActor(UClass* ActorClass, const FTransform& Transform, TFunction<void(AActor*)> Initializer);
+
+	FORCEINLINE int32 GetNumPending() const { return Pending.Num(); }
+
+protected:
+	/** <UWorldSubsystem>*/
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** </UWorldSubsystem>*/
+
+private:
+	void SpawnNow(FQueuedSpawn& Request);
+
+	UPROPERTY()
+	TArray<FQueuedSpawn> Pending;
+	uint64 NextSequence = 0;
+};
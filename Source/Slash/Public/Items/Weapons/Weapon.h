@@ -4,10 +4,20 @@
 
 #include "CoreMinimal.h"
 #include "Items/Item.h"
+#include "Items/Weapons/WeaponHitRegistry.h"
+#include "CollisionQueryParams.h"
+#include "WorldCollision.h"
 #include "Weapon.generated.h"
 
 class USoundBase;
 class UBoxComponent;
+
+// async weapon trace submitted this frame, read back next frame
+struct FPendingWeaponTrace
+{
+	FTraceHandle Handle;
+	uint32 SwingId = 0;
+};
 /**
  * 
  */
@@ -19,12 +29,21 @@ class SLASH_API AWeapon : public AItem
 public:
 	// Sets default values for this actor's properties
 	AWeapon();
+	virtual void Tick(float DeltaTime) override;
 
 	void Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator);
 	void AttachMeshToSocket(USceneComponent* InParent, const FName& InSocketName);
 
-	// used to ensure only have on hit per attack
-	TArray<AActor*> IgnoreActors;
+	/** <IPoolableInterface>*/
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReleasedToPool() override;
+	/** </IPoolableInterface>*/
+
+	/** Applies impact fields through UImpactFieldSubsystem, or the Blueprint CreateFields when native fields are off */
+	void SpawnImpactFields(const FVector& FieldLocation);
+
+	/** Starts or ends a swing, called through ABaseCharacter::SetWeaponCollisionEnabled */
+	void SetWeaponCollisionEnabled(ECollisionEnabled::Type CollisionEnabled);
 	
 protected:
 	virtual void BeginPlay() override;
@@ -39,9 +58,19 @@ private:
 	void PlayEquipSound();
 	void DisableSphereCollision();
 	void DeactivateEmbers();
+	void BeginSwing();
+	bool RegisterHit(AActor* HitActor);
 	void BoxTrace(FHitResult& BoxHit);
-	void ExecuteGetHit(FHitResult& BoxHit);
+	/** Returns true if the points come from the owner's baked trajectory rather than BoxTraceStart/Stop */
+	bool GetBladeTracePoints(FVector& OutStart, FVector& OutStop) const;
+	void SweepBlade();
+	void SweepBladeStep(const FVector& FromStart, const FVector& FromStop, const FVector& ToStart, const FVector& ToStop);
+	void ProcessHit(const FHitResult& Hit);
+	bool ShouldUseAsyncTraces() const;
+	void ConsumeAsyncTraces();
+	void ExecuteGetHit(const FHitResult& BoxHit);
 	bool IsActorSameTypeAs(AActor* OtherActor);
+	void ClearTickPrerequisite();
 
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	FVector BoxTraceExtent = FVector(5.f);
@@ -64,8 +93,49 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	float Damage = 20.f;
 
+	// sweep the blade from its last pose to its current one every frame instead of waiting for WeaponCollisionBox overlaps
+	// required for baked attack trajectories, the overlap box only moves with the posed skeleton
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
+	bool bUseSweptHitDetection = true;
+
+	// a frame's movement is split into sub-steps so no single sweep turns the blade more than this many degrees
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (EditCondition = "bUseSweptHitDetection"))
+	float MaxSweepStepAngle = 20.f;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (EditCondition = "bUseSweptHitDetection", ClampMin = "1"))
+	int32 MaxSweepSubsteps = 4;
+
+	// submit hit traces to the async trace API and apply their hits next frame, see slash.Weapon.AsyncTraces
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
+	bool bUseAsyncTraces = false;
+
+	// the mesh we wait on each tick, removed again before the next equip or when going back to the pool
+	TWeakObjectPtr<USceneComponent> TickPrerequisiteParent;
+
+	bool bSweeping = false;
+	FVector PreviousTraceStart;
+	FVector PreviousTraceStop;
+
+	// used to ensure only one hit per target per attack
+	FWeaponHitRegistry HitRegistry;
+
+	// ignores the weapon, its owner and everything already hit this swing, so physics filters them out directly
+	FCollisionQueryParams HitQueryParams;
+
+	// hits are found by object type, so a blocking wall or the first victim doesn't hide everything behind it
+	FCollisionObjectQueryParams HitObjectParams;
+
+	// reused by every sweep so the hit path doesn't allocate
+	TArray<FHitResult> SweepHits;
+
+	TArray<FPendingWeaponTrace> PendingTraces;
+	FTraceDatum AsyncTraceDatum;
+
 public:
 	FORCEINLINE UBoxComponent* GetWeaponCollisionBox() const {return WeaponCollisionBox;}
+	FORCEINLINE USceneComponent* GetBoxTraceStart() const { return BoxTraceStart; }
+	FORCEINLINE USceneComponent* GetBoxTraceStop() const { return BoxTraceStop; }
+	FORCEINLINE bool UsesSweptHitDetection() const { return bUseSweptHitDetection; }
 };
 
 
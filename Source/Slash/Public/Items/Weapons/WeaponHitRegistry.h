@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * The actors a weapon has already hit during its current swing, so each one is hit once per swing.
+ * It is reset rather than reallocated when a swing begins, and the set storage is inline, so
+ * registering hits never touches the heap for up to InlineHits victims per swing.
+ */
+struct FWeaponHitRegistry
+{
+	static constexpr int32 InlineHits = 8;
+
+	void BeginSwing()
+	{
+		++SwingId;
+		HitActors.Reset();
+	}
+
+	/** Returns false if Actor was already hit this swing */
+	bool RegisterHit(const AActor* Actor)
+	{
+		bool bAlreadyHit = false;
+		HitActors.Add(TObjectKey<AActor>(Actor), &bAlreadyHit);
+		return !bAlreadyHit;
+	}
+
+	bool WasHit(const AActor* Actor) const { return HitActors.Contains(TObjectKey<AActor>(Actor)); }
+
+	// hits resolved after the swing they were found in can check this to see if they're stale
+	uint32 GetSwingId() const { return SwingId; }
+	int32 GetNumHits() const { return HitActors.Num(); }
+
+private:
+	uint32 SwingId = 0;
+	TSet<TObjectKey<AActor>, DefaultKeyFuncs<TObjectKey<AActor>>, TInlineSetAllocator<InlineHits>> HitActors;
+};
@@ -2,4 +2,10 @@
 
 #pragma once
 
-#include "CoreMinimal.h"
\ No newline at end of file
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSlash, Log, All);
+
+// stat group used by the game systems, view in game with "stat Slash"
+DECLARE_STATS_GROUP(TEXT("Slash"), STATGROUP_Slash, STATCAT_Advanced);